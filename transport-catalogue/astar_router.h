@@ -0,0 +1,103 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "dijkstra_router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Point-to-point search ordered by weight + lower_bound(vertex, to).
+//The bound has to be consistent: lower_bound(u, t) <= weight(u, v) + lower_bound(v, t)
+//for every edge (u, v), then every vertex is settled once and routes stay optimal.
+template <typename Weight>
+class AStarRouter final : public RouterBase<Weight> {
+private:
+
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+
+    using typename RouterBase<Weight>::RouteInfo;
+    using LowerBound = std::function<Weight(VertexId from, VertexId to)>;
+
+    AStarRouter(const Graph& graph, LowerBound lower_bound);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+
+    static SearchScratch<Weight>& GetScratch() {
+        thread_local SearchScratch<Weight> scratch;
+        return scratch;
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    LowerBound lower_bound_;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, LowerBound lower_bound)
+    : graph_(graph)
+    , lower_bound_(std::move(lower_bound))
+{
+    for (const auto& edge : graph.GetEdges()) {
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(VertexId from,
+                                                                                       VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    SearchScratch<Weight>& scratch = GetScratch();
+    scratch.Prepare(vertex_count);
+    scratch.Relax(from, ZERO_WEIGHT, std::nullopt, lower_bound_(from, to));
+
+    while (const auto vertex = scratch.PopNext()) {
+        if (*vertex == to) {
+            break;
+        }
+        const Weight& weight = scratch.GetWeight(*vertex);
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(*vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight edge_to_weight = weight + edge.weight;
+            //The bound is only evaluated for vertices whose weight improves
+            if (scratch.IsSettled(edge.to)
+                || (scratch.IsReached(edge.to) && !(edge_to_weight < scratch.GetWeight(edge.to)))) {
+                continue;
+            }
+            scratch.Relax(edge.to, edge_to_weight, edge_id, edge_to_weight + lower_bound_(edge.to, to));
+        }
+    }
+
+    if (!scratch.IsSettled(to)) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = scratch.GetPrevEdge(to);
+         edge_id;
+         edge_id = scratch.GetPrevEdge(graph_.GetEdge(*edge_id).from))
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{scratch.GetWeight(to), std::move(edges)};
+}
+
+}  // namespace graph
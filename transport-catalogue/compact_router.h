@@ -0,0 +1,201 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//All-pairs table packed into one contiguous V x V allocation of 8-byte cells.
+//Total weights are kept as 32-bit fixed point (WeightTraits<Weight>::ToFixedPoint),
+//the full weight of a route is summed back from its edges in BuildRoute.
+template <typename Weight>
+class CompactRouter final : public RouterBase<Weight> {
+private:
+
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+
+    using typename RouterBase<Weight>::RouteInfo;
+
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t UNREACHABLE = std::numeric_limits<uint32_t>::max();
+
+    struct RouteInternalData {
+        uint32_t prev_edge = NO_EDGE;
+        uint32_t weight = UNREACHABLE;
+    };
+    using RoutesInternalData = std::vector<RouteInternalData>;
+
+    explicit CompactRouter(const Graph& graph);
+    CompactRouter(const Graph& graph, RoutesInternalData routes_internal_data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    const RoutesInternalData& GetRoutesInternalData() const {
+        return routes_internal_data_;
+    }
+
+private:
+
+    void InitializeRoutesInternalData(const Graph& graph) {
+        if (graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for the compact routes table");
+        }
+        const size_t vertex_count = graph.GetVertexCount();
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            routes_internal_data_[vertex * vertex_count + vertex] = RouteInternalData{NO_EDGE, 0};
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                const uint64_t weight = WeightTraits<Weight>::ToFixedPoint(edge.weight);
+                if (weight >= UNREACHABLE) {
+                    throw std::overflow_error("Edge weight doesn't fit the compact routes table");
+                }
+                auto& route_internal_data = routes_internal_data_[vertex * vertex_count + edge.to];
+                if (route_internal_data.weight > weight) {
+                    route_internal_data = RouteInternalData{static_cast<uint32_t>(edge_id),
+                                                            static_cast<uint32_t>(weight)};
+                }
+            }
+        }
+    }
+
+    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
+        const RouteInternalData* routes_through = &routes_internal_data_[vertex_through * vertex_count];
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            RouteInternalData* routes_from = &routes_internal_data_[vertex_from * vertex_count];
+            const RouteInternalData route_from = routes_from[vertex_through];
+            if (route_from.weight == UNREACHABLE) {
+                continue;
+            }
+            for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+                const RouteInternalData route_to = routes_through[vertex_to];
+                if (route_to.weight == UNREACHABLE) {
+                    continue;
+                }
+                const uint64_t candidate_weight = uint64_t{route_from.weight} + route_to.weight;
+                if (candidate_weight < routes_from[vertex_to].weight) {
+                    routes_from[vertex_to] = {route_to.prev_edge != NO_EDGE ? route_to.prev_edge : route_from.prev_edge,
+                                              static_cast<uint32_t>(candidate_weight)};
+                } else if (candidate_weight >= UNREACHABLE && routes_from[vertex_to].weight == UNREACHABLE) {
+                    throw std::overflow_error("Route weight doesn't fit the compact routes table");
+                }
+            }
+        }
+    }
+
+    //states is scratch space of the vertex count
+    void CheckNoCycles(const RouteInternalData* routes_from, std::vector<uint8_t>& states) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    RoutesInternalData routes_internal_data_;
+};
+
+template <typename Weight>
+CompactRouter<Weight>::CompactRouter(const Graph& graph)
+    : graph_(graph)
+    , routes_internal_data_(graph.GetVertexCount() * graph.GetVertexCount())
+{
+    InitializeRoutesInternalData(graph);
+
+    const size_t vertex_count = graph.GetVertexCount();
+    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    }
+}
+
+template <typename Weight>
+CompactRouter<Weight>::CompactRouter(const Graph& graph, RoutesInternalData routes_internal_data)
+    : graph_(graph)
+    , routes_internal_data_(std::move(routes_internal_data))
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    if (routes_internal_data_.size() != vertex_count * vertex_count) {
+        throw std::invalid_argument("Routes internal data doesn't match the graph");
+    }
+    //BuildRoute follows prev_edge back to the source, every edge has to end at its cell's vertex
+    //and start at a vertex the source reaches, and the edges of a row can't form a cycle
+    std::vector<uint8_t> states(vertex_count);
+    for (VertexId from = 0; from < vertex_count; ++from) {
+        const RouteInternalData* routes_from = &routes_internal_data_[from * vertex_count];
+        for (VertexId to = 0; to < vertex_count; ++to) {
+            const RouteInternalData& cell = routes_from[to];
+            if (cell.prev_edge == NO_EDGE) {
+                continue;
+            }
+            if (cell.weight == UNREACHABLE || cell.prev_edge >= graph.GetEdgeCount()
+                || graph.GetEdge(cell.prev_edge).to != to
+                || routes_from[graph.GetEdge(cell.prev_edge).from].weight == UNREACHABLE) {
+                throw std::invalid_argument("Routes internal data doesn't match the graph");
+            }
+        }
+        CheckNoCycles(routes_from, states);
+    }
+}
+
+template <typename Weight>
+void CompactRouter<Weight>::CheckNoCycles(const RouteInternalData* routes_from, std::vector<uint8_t>& states) const {
+    enum : uint8_t { UNVISITED, ON_PATH, DONE };
+    std::fill(states.begin(), states.end(), UNVISITED);
+    std::vector<VertexId> path;
+    for (VertexId start = 0; start < states.size(); ++start) {
+        for (VertexId vertex = start; states[vertex] == UNVISITED;) {
+            states[vertex] = ON_PATH;
+            path.push_back(vertex);
+            if (routes_from[vertex].prev_edge == NO_EDGE) {
+                break;
+            }
+            vertex = graph_.GetEdge(routes_from[vertex].prev_edge).from;
+            if (states[vertex] == ON_PATH) {
+                throw std::invalid_argument("Routes internal data doesn't match the graph");
+            }
+        }
+        for (const VertexId on_path : path) {
+            states[on_path] = DONE;
+        }
+        path.clear();
+    }
+}
+
+template <typename Weight>
+std::optional<typename CompactRouter<Weight>::RouteInfo> CompactRouter<Weight>::BuildRoute(VertexId from,
+                                                                                           VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const RouteInternalData* routes_from = &routes_internal_data_[from * vertex_count];
+    if (routes_from[to].weight == UNREACHABLE) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (uint32_t edge_id = routes_from[to].prev_edge;
+         edge_id != NO_EDGE;
+         edge_id = routes_from[graph_.GetEdge(edge_id).from].prev_edge)
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,491 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "dijkstra_router.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Contraction hierarchies: vertices are contracted one by one in order of importance and
+//shortcuts keep the distances between the remaining ones. Queries run a bidirectional
+//search that only goes up the hierarchy, shortcuts are unpacked into the graph's edges.
+//Arc ids below GetEdgeCount() are graph edges, arc GetEdgeCount() + i is shortcuts[i].
+template <typename Weight>
+class ContractionHierarchy final : public RouterBase<Weight> {
+private:
+
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+
+    using typename RouterBase<Weight>::RouteInfo;
+
+    struct Shortcut {
+        EdgeId first_arc;
+        EdgeId second_arc;
+    };
+
+    struct HierarchyData {
+        std::vector<size_t> vertex_ranks;
+        std::vector<Shortcut> shortcuts;
+    };
+
+    explicit ContractionHierarchy(const Graph& graph);
+    ContractionHierarchy(const Graph& graph, HierarchyData hierarchy_data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    const HierarchyData& GetHierarchyData() const {
+        return hierarchy_data_;
+    }
+
+private:
+
+    struct Arc {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+    };
+
+    struct ContractionArc {
+        VertexId vertex;
+        Weight weight;
+        EdgeId arc_id;
+    };
+
+    struct PendingShortcut {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first_arc;
+        EdgeId second_arc;
+    };
+
+    struct ContractionState {
+        std::vector<std::vector<ContractionArc>> out_arcs;
+        std::vector<std::vector<ContractionArc>> in_arcs;
+        std::vector<bool> contracted;
+        std::vector<int> contracted_neighbours;
+        std::vector<size_t> target_marks;
+        std::vector<Weight> target_weights;
+        size_t target_mark = 0;
+        SearchScratch<Weight> witness_scratch;
+    };
+
+    void Contract();
+    void CheckEdges() const;
+    void InitializeArcs();
+    void BuildUpwardArcs();
+
+    int EvaluateVertex(ContractionState& state, VertexId vertex, std::vector<PendingShortcut>& shortcuts);
+    void AddShortcut(ContractionState& state, const PendingShortcut& shortcut);
+    void RunWitnessSearch(ContractionState& state, VertexId source, VertexId excluded, const Weight& weight_limit,
+                          size_t target_count);
+
+    void UnpackArc(EdgeId arc_id, std::vector<EdgeId>& edges) const;
+
+    static std::array<SearchScratch<Weight>, 2>& GetScratches() {
+        thread_local std::array<SearchScratch<Weight>, 2> scratches;
+        return scratches;
+    }
+
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+    static constexpr Weight ZERO_WEIGHT{};
+
+    const Graph& graph_;
+    HierarchyData hierarchy_data_;
+    std::vector<Arc> arcs_;
+    std::vector<std::vector<EdgeId>> upward_out_arcs_;
+    std::vector<std::vector<EdgeId>> upward_in_arcs_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+{
+    CheckEdges();
+    InitializeArcs();
+    Contract();
+    BuildUpwardArcs();
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, HierarchyData hierarchy_data)
+    : graph_(graph)
+    , hierarchy_data_(std::move(hierarchy_data))
+{
+    if (hierarchy_data_.vertex_ranks.size() != graph.GetVertexCount()) {
+        throw std::invalid_argument("Hierarchy data doesn't match the graph");
+    }
+    InitializeArcs();
+    for (const auto& shortcut : hierarchy_data_.shortcuts) {
+        if (shortcut.first_arc >= arcs_.size() || shortcut.second_arc >= arcs_.size()) {
+            throw std::invalid_argument("Hierarchy data doesn't match the graph");
+        }
+        const Arc& first = arcs_[shortcut.first_arc];
+        const Arc& second = arcs_[shortcut.second_arc];
+        arcs_.push_back(Arc{first.from, second.to, first.weight + second.weight});
+    }
+    BuildUpwardArcs();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::CheckEdges() const {
+    for (const auto& edge : graph_.GetEdges()) {
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::InitializeArcs() {
+    arcs_.clear();
+    arcs_.reserve(graph_.GetEdgeCount() + hierarchy_data_.shortcuts.size());
+    for (const auto& edge : graph_.GetEdges()) {
+        arcs_.push_back(Arc{edge.from, edge.to, edge.weight});
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    ContractionState state;
+    state.out_arcs.resize(vertex_count);
+    state.in_arcs.resize(vertex_count);
+    state.contracted.assign(vertex_count, false);
+    state.contracted_neighbours.assign(vertex_count, 0);
+    state.target_marks.assign(vertex_count, 0);
+    state.target_weights.assign(vertex_count, ZERO_WEIGHT);
+
+    for (EdgeId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+        const Arc& arc = arcs_[arc_id];
+        if (arc.from == arc.to) {
+            continue;
+        }
+        auto& out_arcs = state.out_arcs[arc.from];
+        const auto it = std::find_if(out_arcs.begin(), out_arcs.end(), [&arc](const ContractionArc& out_arc) {
+            return out_arc.vertex == arc.to;
+        });
+        if (it == out_arcs.end()) {
+            out_arcs.push_back({arc.to, arc.weight, arc_id});
+            state.in_arcs[arc.to].push_back({arc.from, arc.weight, arc_id});
+        } else if (arc.weight < it->weight) {
+            *it = {arc.to, arc.weight, arc_id};
+            for (auto& in_arc : state.in_arcs[arc.to]) {
+                if (in_arc.vertex == arc.from) {
+                    in_arc = {arc.from, arc.weight, arc_id};
+                }
+            }
+        }
+    }
+
+    std::vector<PendingShortcut> shortcuts;
+    using QueueItem = std::pair<int, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.push({EvaluateVertex(state, vertex, shortcuts), vertex});
+    }
+
+    hierarchy_data_.vertex_ranks.assign(vertex_count, 0);
+    size_t rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        //Priorities go stale as neighbours get contracted, they are refreshed lazily
+        const int priority = EvaluateVertex(state, vertex, shortcuts);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({priority, vertex});
+            continue;
+        }
+
+        for (const auto& shortcut : shortcuts) {
+            AddShortcut(state, shortcut);
+        }
+        state.contracted[vertex] = true;
+        hierarchy_data_.vertex_ranks[vertex] = rank++;
+        for (const auto& arc : state.out_arcs[vertex]) {
+            ++state.contracted_neighbours[arc.vertex];
+        }
+        for (const auto& arc : state.in_arcs[vertex]) {
+            ++state.contracted_neighbours[arc.vertex];
+        }
+    }
+}
+
+//Collects the shortcuts that contracting the vertex needs and returns its priority
+//(edge difference plus the number of already contracted neighbours)
+template <typename Weight>
+int ContractionHierarchy<Weight>::EvaluateVertex(ContractionState& state, VertexId vertex,
+                                                 std::vector<PendingShortcut>& shortcuts) {
+    shortcuts.clear();
+    std::vector<ContractionArc> in_arcs;
+    std::vector<ContractionArc> out_arcs;
+    for (const auto& arc : state.in_arcs[vertex]) {
+        if (!state.contracted[arc.vertex]) {
+            in_arcs.push_back(arc);
+        }
+    }
+    for (const auto& arc : state.out_arcs[vertex]) {
+        if (!state.contracted[arc.vertex]) {
+            out_arcs.push_back(arc);
+        }
+    }
+
+    for (const auto& in_arc : in_arcs) {
+        std::optional<Weight> weight_limit;
+        size_t target_count = 0;
+        ++state.target_mark;
+        for (const auto& out_arc : out_arcs) {
+            if (out_arc.vertex == in_arc.vertex) {
+                continue;
+            }
+            const Weight candidate_weight = in_arc.weight + out_arc.weight;
+            if (!weight_limit || *weight_limit < candidate_weight) {
+                weight_limit = candidate_weight;
+            }
+            state.target_marks[out_arc.vertex] = state.target_mark;
+            state.target_weights[out_arc.vertex] = candidate_weight;
+            ++target_count;
+        }
+        if (!weight_limit) {
+            continue;
+        }
+
+        RunWitnessSearch(state, in_arc.vertex, vertex, *weight_limit, target_count);
+        const auto& scratch = state.witness_scratch;
+        for (const auto& out_arc : out_arcs) {
+            if (out_arc.vertex == in_arc.vertex) {
+                continue;
+            }
+            const Weight& candidate_weight = state.target_weights[out_arc.vertex];
+            if (scratch.IsReached(out_arc.vertex) && !(candidate_weight < scratch.GetWeight(out_arc.vertex))) {
+                continue;
+            }
+            shortcuts.push_back({in_arc.vertex, out_arc.vertex, candidate_weight, in_arc.arc_id, out_arc.arc_id});
+        }
+    }
+
+    return static_cast<int>(shortcuts.size()) - static_cast<int>(in_arcs.size() + out_arcs.size())
+           + state.contracted_neighbours[vertex];
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::AddShortcut(ContractionState& state, const PendingShortcut& shortcut) {
+    const EdgeId arc_id = arcs_.size();
+    arcs_.push_back(Arc{shortcut.from, shortcut.to, shortcut.weight});
+    hierarchy_data_.shortcuts.push_back(Shortcut{shortcut.first_arc, shortcut.second_arc});
+
+    auto& out_arcs = state.out_arcs[shortcut.from];
+    const auto it = std::find_if(out_arcs.begin(), out_arcs.end(), [&shortcut](const ContractionArc& arc) {
+        return arc.vertex == shortcut.to;
+    });
+    if (it == out_arcs.end()) {
+        out_arcs.push_back({shortcut.to, shortcut.weight, arc_id});
+        state.in_arcs[shortcut.to].push_back({shortcut.from, shortcut.weight, arc_id});
+        return;
+    }
+    *it = {shortcut.to, shortcut.weight, arc_id};
+    for (auto& in_arc : state.in_arcs[shortcut.to]) {
+        if (in_arc.vertex == shortcut.from) {
+            in_arc = {shortcut.from, shortcut.weight, arc_id};
+        }
+    }
+}
+
+//Dijkstra from source over not yet contracted vertices except the one being contracted.
+//Stops once every marked target is reached within its candidate weight or settled.
+template <typename Weight>
+void ContractionHierarchy<Weight>::RunWitnessSearch(ContractionState& state, VertexId source, VertexId excluded,
+                                                    const Weight& weight_limit, size_t target_count) {
+    auto& scratch = state.witness_scratch;
+    scratch.Prepare(graph_.GetVertexCount());
+    scratch.Relax(source, ZERO_WEIGHT, std::nullopt);
+
+    const auto resolve_target = [&state, &target_count](VertexId vertex) {
+        if (state.target_marks[vertex] == state.target_mark) {
+            state.target_marks[vertex] = 0;
+            --target_count;
+        }
+    };
+
+    size_t settled_count = 0;
+    while (const auto vertex = scratch.PopNext()) {
+        const Weight& weight = scratch.GetWeight(*vertex);
+        if (weight_limit < weight || ++settled_count > WITNESS_SETTLE_LIMIT) {
+            break;
+        }
+        resolve_target(*vertex);
+        for (const auto& arc : state.out_arcs[*vertex]) {
+            if (arc.vertex == excluded || state.contracted[arc.vertex]) {
+                continue;
+            }
+            const Weight arc_weight = weight + arc.weight;
+            if (scratch.Relax(arc.vertex, arc_weight, std::nullopt)
+                && !(state.target_weights[arc.vertex] < arc_weight)) {
+                resolve_target(arc.vertex);
+            }
+        }
+        if (target_count == 0) {
+            break;
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildUpwardArcs() {
+    const auto& ranks = hierarchy_data_.vertex_ranks;
+    upward_out_arcs_.assign(graph_.GetVertexCount(), {});
+    upward_in_arcs_.assign(graph_.GetVertexCount(), {});
+    for (EdgeId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+        const Arc& arc = arcs_[arc_id];
+        if (ranks[arc.from] < ranks[arc.to]) {
+            upward_out_arcs_[arc.from].push_back(arc_id);
+        } else if (ranks[arc.to] < ranks[arc.from]) {
+            upward_in_arcs_[arc.to].push_back(arc_id);
+        }
+    }
+
+    //Only the lightest of parallel arcs can be on a shortest path
+    const auto keep_lightest = [this](std::vector<EdgeId>& arc_ids, auto get_neighbour) {
+        std::stable_sort(arc_ids.begin(), arc_ids.end(), [&](EdgeId lhs, EdgeId rhs) {
+            return get_neighbour(arcs_[lhs]) < get_neighbour(arcs_[rhs]);
+        });
+        size_t kept = 0;
+        for (const EdgeId arc_id : arc_ids) {
+            if (kept > 0 && get_neighbour(arcs_[arc_ids[kept - 1]]) == get_neighbour(arcs_[arc_id])) {
+                if (arcs_[arc_id].weight < arcs_[arc_ids[kept - 1]].weight) {
+                    arc_ids[kept - 1] = arc_id;
+                }
+                continue;
+            }
+            arc_ids[kept++] = arc_id;
+        }
+        arc_ids.resize(kept);
+        arc_ids.shrink_to_fit();
+    };
+    for (auto& arc_ids : upward_out_arcs_) {
+        keep_lightest(arc_ids, [](const Arc& arc) { return arc.to; });
+    }
+    for (auto& arc_ids : upward_in_arcs_) {
+        keep_lightest(arc_ids, [](const Arc& arc) { return arc.from; });
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo>
+ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{ZERO_WEIGHT, {}};
+    }
+
+    auto& [forward, backward] = GetScratches();
+    forward.Prepare(vertex_count);
+    backward.Prepare(vertex_count);
+    forward.Relax(from, ZERO_WEIGHT, std::nullopt);
+    backward.Relax(to, ZERO_WEIGHT, std::nullopt);
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = 0;
+
+    //Upward arcs of one direction lead down in the other one, they are used to stall
+    //vertices that are reached suboptimally (stall-on-demand)
+    const auto step = [&](SearchScratch<Weight>& scratch, const SearchScratch<Weight>& opposite,
+                          const std::vector<std::vector<EdgeId>>& upward_arcs,
+                          const std::vector<std::vector<EdgeId>>& downward_arcs, bool is_forward) {
+        const VertexId vertex = *scratch.PopNext();
+        const Weight& weight = scratch.GetWeight(vertex);
+        if (opposite.IsReached(vertex)) {
+            const Weight total_weight = weight + opposite.GetWeight(vertex);
+            if (!best_weight || total_weight < *best_weight) {
+                best_weight = total_weight;
+                meeting_vertex = vertex;
+            }
+        }
+        for (const EdgeId arc_id : downward_arcs[vertex]) {
+            const Arc& arc = arcs_[arc_id];
+            const VertexId higher_vertex = is_forward ? arc.from : arc.to;
+            if (scratch.IsReached(higher_vertex) && scratch.GetWeight(higher_vertex) + arc.weight < weight) {
+                return;
+            }
+        }
+        for (const EdgeId arc_id : upward_arcs[vertex]) {
+            const Arc& arc = arcs_[arc_id];
+            scratch.Relax(is_forward ? arc.to : arc.from, weight + arc.weight, arc_id);
+        }
+    };
+
+    while (true) {
+        const auto forward_key = forward.PeekKey();
+        const auto backward_key = backward.PeekKey();
+        const bool forward_done = !forward_key || (best_weight && !(*forward_key < *best_weight));
+        const bool backward_done = !backward_key || (best_weight && !(*backward_key < *best_weight));
+        if (forward_done && backward_done) {
+            break;
+        }
+        if (!forward_done && (backward_done || !(*backward_key < *forward_key))) {
+            step(forward, backward, upward_out_arcs_, upward_in_arcs_, true);
+        } else {
+            step(backward, forward, upward_in_arcs_, upward_out_arcs_, false);
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> forward_arcs;
+    for (auto arc_id = forward.GetPrevEdge(meeting_vertex); arc_id; arc_id = forward.GetPrevEdge(arcs_[*arc_id].from)) {
+        forward_arcs.push_back(*arc_id);
+    }
+    std::reverse(forward_arcs.begin(), forward_arcs.end());
+    for (auto arc_id = backward.GetPrevEdge(meeting_vertex); arc_id; arc_id = backward.GetPrevEdge(arcs_[*arc_id].to)) {
+        forward_arcs.push_back(*arc_id);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId arc_id : forward_arcs) {
+        UnpackArc(arc_id, edges);
+    }
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackArc(EdgeId arc_id, std::vector<EdgeId>& edges) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    std::vector<EdgeId> stack{arc_id};
+    while (!stack.empty()) {
+        const EdgeId current = stack.back();
+        stack.pop_back();
+        if (current < edge_count) {
+            edges.push_back(current);
+            continue;
+        }
+        const Shortcut& shortcut = hierarchy_data_.shortcuts[current - edge_count];
+        stack.push_back(shortcut.second_arc);
+        stack.push_back(shortcut.first_arc);
+    }
+}
+
+}  // namespace graph
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "search_scratch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Answers every query with its own Dijkstra search instead of keeping a V x V table.
+//A batch of queries from one source shares a single search tree.
+//Search arrays are thread_local and reused between queries.
+template <typename Weight>
+class DijkstraRouter final : public RouterBase<Weight> {
+private:
+
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+
+    using typename RouterBase<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override;
+
+    //Route with the edge weights given by weight_of(edge_id) instead of the stored ones,
+    //the returned weights must be non-negative
+    template <typename WeightOf>
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, WeightOf weight_of) const;
+
+    //Vertices with a route not heavier than max_weight and the route weights, lightest first.
+    //The search stops at the first heavier vertex.
+    std::vector<std::pair<VertexId, Weight>> BuildReachable(VertexId from, const Weight& max_weight) const;
+
+    //Route weights to every target from a single search, without extracting the routes
+    std::vector<std::optional<Weight>> BuildRouteWeights(VertexId from, const std::vector<VertexId>& targets) const;
+
+private:
+
+    //Settles vertices until every target is settled or the queue is empty
+    template <typename WeightOf>
+    void RunSearch(SearchScratch<Weight>& scratch, VertexId from, std::vector<VertexId> targets,
+                   WeightOf weight_of) const;
+    std::optional<RouteInfo> ExtractRoute(const SearchScratch<Weight>& scratch, VertexId to) const;
+    void CheckVertex(VertexId vertex) const;
+
+    static SearchScratch<Weight>& GetScratch() {
+        thread_local SearchScratch<Weight> scratch;
+        return scratch;
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    for (const auto& edge : graph.GetEdges()) {
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+void DijkstraRouter<Weight>::CheckVertex(VertexId vertex) const {
+    if (vertex >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+}
+
+template <typename Weight>
+template <typename WeightOf>
+void DijkstraRouter<Weight>::RunSearch(SearchScratch<Weight>& scratch, VertexId from,
+                                       std::vector<VertexId> targets, WeightOf weight_of) const {
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    size_t targets_left = targets.size();
+
+    scratch.Prepare(graph_.GetVertexCount());
+    scratch.Relax(from, ZERO_WEIGHT, std::nullopt);
+
+    while (const auto vertex = scratch.PopNext()) {
+        if (std::binary_search(targets.begin(), targets.end(), *vertex) && --targets_left == 0) {
+            break;
+        }
+        const Weight& weight = scratch.GetWeight(*vertex);
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(*vertex)) {
+            scratch.Relax(graph_.GetEdge(edge_id).to, weight + weight_of(edge_id), edge_id);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::ExtractRoute(
+        const SearchScratch<Weight>& scratch, VertexId to) const {
+    if (!scratch.IsSettled(to)) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = scratch.GetPrevEdge(to);
+         edge_id;
+         edge_id = scratch.GetPrevEdge(graph_.GetEdge(*edge_id).from))
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{scratch.GetWeight(to), std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                             VertexId to) const {
+    CheckVertex(from);
+    CheckVertex(to);
+
+    SearchScratch<Weight>& scratch = GetScratch();
+    RunSearch(scratch, from, {to}, [this](EdgeId edge_id) -> const Weight& {
+        return graph_.GetEdge(edge_id).weight;
+    });
+    return ExtractRoute(scratch, to);
+}
+
+template <typename Weight>
+template <typename WeightOf>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(
+        VertexId from, VertexId to, WeightOf weight_of) const {
+    CheckVertex(from);
+    CheckVertex(to);
+
+    SearchScratch<Weight>& scratch = GetScratch();
+    RunSearch(scratch, from, {to}, weight_of);
+    return ExtractRoute(scratch, to);
+}
+
+template <typename Weight>
+std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>> DijkstraRouter<Weight>::BuildRoutes(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    CheckVertex(from);
+    for (const VertexId to : targets) {
+        CheckVertex(to);
+    }
+
+    SearchScratch<Weight>& scratch = GetScratch();
+    RunSearch(scratch, from, targets, [this](EdgeId edge_id) -> const Weight& {
+        return graph_.GetEdge(edge_id).weight;
+    });
+
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(targets.size());
+    for (const VertexId to : targets) {
+        routes.push_back(ExtractRoute(scratch, to));
+    }
+    return routes;
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> DijkstraRouter<Weight>::BuildReachable(VertexId from,
+                                                                                const Weight& max_weight) const {
+    CheckVertex(from);
+
+    SearchScratch<Weight>& scratch = GetScratch();
+    scratch.Prepare(graph_.GetVertexCount());
+    scratch.Relax(from, ZERO_WEIGHT, std::nullopt);
+
+    std::vector<std::pair<VertexId, Weight>> reachable;
+    while (const auto vertex = scratch.PopNext()) {
+        const Weight& weight = scratch.GetWeight(*vertex);
+        if (max_weight < weight) {
+            break;
+        }
+        reachable.emplace_back(*vertex, weight);
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(*vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            scratch.Relax(edge.to, weight + edge.weight, edge_id);
+        }
+    }
+    return reachable;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> DijkstraRouter<Weight>::BuildRouteWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    CheckVertex(from);
+    for (const VertexId to : targets) {
+        CheckVertex(to);
+    }
+
+    SearchScratch<Weight>& scratch = GetScratch();
+    RunSearch(scratch, from, targets, [this](EdgeId edge_id) -> const Weight& {
+        return graph_.GetEdge(edge_id).weight;
+    });
+
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    for (const VertexId to : targets) {
+        weights.push_back(scratch.IsSettled(to) ? std::make_optional(scratch.GetWeight(to)) : std::nullopt);
+    }
+    return weights;
+}
+
+}  // namespace graph
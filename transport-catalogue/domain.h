@@ -1,6 +1,7 @@
 #pragma once
 
 #include "geo.h"
+#include <cstdint>
 #include <deque>
 #include <set>
 #include <string>
@@ -11,9 +12,14 @@
 
 namespace domain {
 
+    //Dense ids of the catalogue, stop ids are also the graph vertices of the stops
+    using StopId = uint32_t;
+    using BusId = uint32_t;
+
     struct Stop {
         std::string name;
         geo::Coordinates coordinates;
+        StopId id = 0;
     };
 
     using StopPtr = const Stop*;
@@ -22,12 +28,32 @@ namespace domain {
         std::string bus_name;
         std::vector<StopPtr> bus_stops;
         bool is_circle;
+        BusId id = 0;
     };
 
     using BusPtr = const Bus*;
 
+    enum class RouterEngine {
+        ALL_PAIRS,
+        DIJKSTRA,
+        COMPACT_ALL_PAIRS,
+        CONTRACTION_HIERARCHIES,
+        A_STAR,
+        MULTI_LEVEL_OVERLAY,
+        HUB_LABELS,
+        ALL_PAIRS_SEARCH,       //the all-pairs table filled by one search per source, equal routes may differ
+    };
+
+    enum class GraphModel {
+        COMPLETE,       //edge for every pair of stops of a bus
+        EXPANDED,       //vertex for every stop of a bus, edges between consecutive stops only
+    };
+
     struct RouteSettings {
         double bus_velocity = 1.0;
         int bus_wait_time = 1;
+        RouterEngine router_engine = RouterEngine::ALL_PAIRS;
+        GraphModel graph_model = GraphModel::COMPLETE;
+        size_t route_cache_size = 1024;        //found routes kept by TransportRouter, 0 disables the cache
     };
 }
@@ -24,4 +24,19 @@ namespace geo {
             * EARTH_RADIUS;
     }
 
+    CartesianPoint ToCartesian(Coordinates coordinates) {
+        using namespace std;
+        static const double dr = M_PI / 180.;
+        const double lat = coordinates.lat * dr;
+        const double lng = coordinates.lng * dr;
+        return {EARTH_RADIUS * cos(lat) * cos(lng), EARTH_RADIUS * cos(lat) * sin(lng), EARTH_RADIUS * sin(lat)};
+    }
+
+    double ComputeChordDistance(const CartesianPoint& from, const CartesianPoint& to) {
+        const double dx = from.x - to.x;
+        const double dy = from.y - to.y;
+        const double dz = from.z - to.z;
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
 }  // namespace geo
@@ -13,4 +13,16 @@ struct Coordinates {
 
 double ComputeDistance(Coordinates from, Coordinates to);
 
+//Point on the Earth's surface in meters, the origin is the centre of the Earth
+struct CartesianPoint {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+};
+
+CartesianPoint ToCartesian(Coordinates coordinates);
+
+//Straight-line distance through the Earth, never longer than ComputeDistance
+double ComputeChordDistance(const CartesianPoint& from, const CartesianPoint& to);
+
 }  // namespace geo
@@ -2,7 +2,9 @@
 
 #include "ranges.h"
 
+#include <cassert>
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -10,6 +12,10 @@ namespace graph {
 using VertexId = size_t;
 using EdgeId = size_t;
 
+//Customization point for weight types, specialized next to the weight type itself
+template <typename Weight>
+struct WeightTraits;
+
 template <typename Weight>
 struct Edge {
     VertexId from;
@@ -17,16 +23,24 @@ struct Edge {
     Weight weight;
 };
 
+//Edges are added while building, Freeze() then sorts them by source into the CSR layout:
+//edges of vertex v are the ids [edge_offsets[v], edge_offsets[v + 1]) of one contiguous array.
+//GetEdge and GetIncidentEdges are not bounds-checked, they are on the hot path of every search.
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
-    using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<ranges::CountingIterator<EdgeId>>;
 
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
+    //Frozen graph from edges sorted by source and their offsets
+    DirectedWeightedGraph(std::vector<Edge<Weight>> edges, std::vector<size_t> edge_offsets);
+
     EdgeId AddEdge(const Edge<Weight>& edge);
+    //Returns the id the edge had before freezing for every new edge id, edges can't be added afterwards
+    std::vector<EdgeId> Freeze();
+    bool IsFrozen() const;
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
@@ -37,39 +51,87 @@ public:
     const std::vector<Edge<Weight>>& GetEdges() const {
         return edges_;
     }
-    const std::vector<IncidenceList>& GetIncidenceLists() const{
-        return incidence_lists_;
-    }
-
-    void SetEdge(std::vector<Edge<Weight>> &edges) {
-        edges_ = std::move(edges);
-    }
-
-    void SetIncidenceList(std::vector<IncidenceList> &incidence_lists) {
-        incidence_lists_ = std::move(incidence_lists);
+    const std::vector<size_t>& GetEdgeOffsets() const {
+        return edge_offsets_;
     }
 
 private:
+    size_t vertex_count_ = 0;
     std::vector<Edge<Weight>> edges_;
-    std::vector<IncidenceList> incidence_lists_;
+    std::vector<size_t> edge_offsets_;        //vertex_count_ + 1 items once frozen, empty before
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : vertex_count_(vertex_count) {
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<Edge<Weight>> edges, std::vector<size_t> edge_offsets)
+    : vertex_count_(edge_offsets.empty() ? 0 : edge_offsets.size() - 1)
+    , edges_(std::move(edges))
+    , edge_offsets_(std::move(edge_offsets)) {
+    if (edge_offsets_.empty() || edge_offsets_.front() != 0 || edge_offsets_.back() != edges_.size()) {
+        throw std::invalid_argument("Edge offsets don't match the edges");
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        if (edge_offsets_[vertex] > edge_offsets_[vertex + 1]) {
+            throw std::invalid_argument("Edge offsets should be non-decreasing");
+        }
+        for (EdgeId edge_id = edge_offsets_[vertex]; edge_id < edge_offsets_[vertex + 1]; ++edge_id) {
+            if (edges_[edge_id].from != vertex || edges_[edge_id].to >= vertex_count_) {
+                throw std::invalid_argument("Edge doesn't match its offsets");
+            }
+        }
+    }
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (IsFrozen()) {
+        throw std::logic_error("Can't add an edge to a frozen graph");
+    }
+    if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
     edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
-    incidence_lists_.at(edge.from).push_back(id);
-    return id;
+    return edges_.size() - 1;
+}
+
+template <typename Weight>
+std::vector<EdgeId> DirectedWeightedGraph<Weight>::Freeze() {
+    if (IsFrozen()) {
+        throw std::logic_error("Graph is already frozen");
+    }
+    //Counting sort by source, stable so every vertex keeps the order its edges were added in
+    edge_offsets_.assign(vertex_count_ + 1, 0);
+    for (const auto& edge : edges_) {
+        ++edge_offsets_[edge.from + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        edge_offsets_[vertex + 1] += edge_offsets_[vertex];
+    }
+
+    std::vector<size_t> positions(edge_offsets_.begin(), edge_offsets_.end() - 1);
+    std::vector<EdgeId> old_ids(edges_.size());
+    std::vector<Edge<Weight>> sorted_edges(edges_.size());
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        const EdgeId new_id = positions[edges_[edge_id].from]++;
+        sorted_edges[new_id] = edges_[edge_id];
+        old_ids[new_id] = edge_id;
+    }
+    edges_ = std::move(sorted_edges);
+    return old_ids;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return !edge_offsets_.empty();
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return vertex_count_;
 }
 
 template <typename Weight>
@@ -79,12 +141,13 @@ size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
 
 template <typename Weight>
 const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+    return edges_[edge_id];
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    assert(IsFrozen());
+    return ranges::AsCountingRange<EdgeId>(edge_offsets_[vertex], edge_offsets_[vertex + 1]);
 }
 }  // namespace graph
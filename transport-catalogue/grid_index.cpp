@@ -0,0 +1,241 @@
+#define _USE_MATH_DEFINES
+#include "grid_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace geo {
+
+    namespace {
+
+        constexpr double DEGREE = M_PI / 180.;
+        constexpr double INFINITE_DISTANCE = std::numeric_limits<double>::infinity();
+        //Cells are widened by the cosine of the middle latitude, it's kept away from zero near the poles
+        constexpr double MIN_LATITUDE_COS = 0.01;
+
+        //Index of the cell holding the value, values outside the grid fall into the cells at its edges
+        uint32_t ToCell(double value, double min_value, double cell_size, uint32_t cell_count) {
+            const double cell = std::floor((value - min_value) / cell_size);
+            if (!(cell > 0.0)) {
+                return 0;
+            }
+            return cell >= cell_count ? cell_count - 1 : static_cast<uint32_t>(cell);
+        }
+
+        bool IsCloser(const GridIndex::Neighbour &lhs, const GridIndex::Neighbour &rhs) {
+            return lhs.distance != rhs.distance ? lhs.distance < rhs.distance : lhs.point < rhs.point;
+        }
+
+    }
+
+    GridIndex::GridIndex(const std::vector<double> &latitudes, const std::vector<double> &longitudes) {
+        if (latitudes.size() != longitudes.size()) {
+            throw std::invalid_argument("Latitudes and longitudes of the points don't match");
+        }
+        const size_t point_count = latitudes.size();
+        index_data_.cell_offsets = {0};
+        if (point_count == 0) {
+            return;
+        }
+
+        const auto [min_latitude, max_latitude] = std::minmax_element(latitudes.begin(), latitudes.end());
+        const auto [min_longitude, max_longitude] = std::minmax_element(longitudes.begin(), longitudes.end());
+        const double latitude_span = *max_latitude - *min_latitude;
+        const double longitude_span = *max_longitude - *min_longitude;
+        //A degree of longitude is shorter than a degree of latitude by the cosine of the latitude
+        const double middle_cos = std::max(MIN_LATITUDE_COS,
+                                           std::cos((*min_latitude + *max_latitude) / 2 * DEGREE));
+        const double scaled_longitude_span = longitude_span * middle_cos;
+
+        const double target_cell_count = std::max(1.0, point_count / POINTS_PER_CELL);
+        double cell_size = latitude_span * scaled_longitude_span > 0.0
+                           ? std::sqrt(latitude_span * scaled_longitude_span / target_cell_count)
+                           : std::max(latitude_span, scaled_longitude_span) / target_cell_count;
+        if (!(cell_size > 0.0)) {
+            cell_size = 1.0;
+        }
+
+        index_data_.min_latitude = *min_latitude;
+        index_data_.min_longitude = *min_longitude;
+        index_data_.cell_height = cell_size;
+        index_data_.cell_width = cell_size / middle_cos;
+        index_data_.row_count = static_cast<uint32_t>(latitude_span / index_data_.cell_height) + 1;
+        index_data_.column_count = static_cast<uint32_t>(longitude_span / index_data_.cell_width) + 1;
+
+        //Counting sort of the points by cell
+        std::vector<uint32_t> point_cells(point_count);
+        index_data_.cell_offsets.assign(static_cast<size_t>(index_data_.row_count) * index_data_.column_count + 1, 0);
+        for (size_t point = 0; point < point_count; ++point) {
+            const uint32_t row = ToCell(latitudes[point], index_data_.min_latitude, index_data_.cell_height,
+                                        index_data_.row_count);
+            const uint32_t column = ToCell(longitudes[point], index_data_.min_longitude, index_data_.cell_width,
+                                           index_data_.column_count);
+            point_cells[point] = row * index_data_.column_count + column;
+            ++index_data_.cell_offsets[point_cells[point] + 1];
+        }
+        for (size_t cell = 0; cell + 1 < index_data_.cell_offsets.size(); ++cell) {
+            index_data_.cell_offsets[cell + 1] += index_data_.cell_offsets[cell];
+        }
+        std::vector<uint32_t> positions(index_data_.cell_offsets.begin(), index_data_.cell_offsets.end() - 1);
+        index_data_.cell_points.resize(point_count);
+        for (size_t point = 0; point < point_count; ++point) {
+            index_data_.cell_points[positions[point_cells[point]]++] = static_cast<uint32_t>(point);
+        }
+
+        FillCellCoordinates(latitudes, longitudes);
+    }
+
+    GridIndex::GridIndex(const std::vector<double> &latitudes, const std::vector<double> &longitudes,
+                         IndexData index_data)
+            : index_data_(std::move(index_data)) {
+        const size_t point_count = latitudes.size();
+        const auto &offsets = index_data_.cell_offsets;
+        if (longitudes.size() != point_count
+            || index_data_.cell_points.size() != point_count
+            || !(index_data_.cell_height > 0.0) || !(index_data_.cell_width > 0.0)
+            || offsets.size() != static_cast<size_t>(index_data_.row_count) * index_data_.column_count + 1
+            || offsets.front() != 0 || offsets.back() != point_count
+            || !std::is_sorted(offsets.begin(), offsets.end())
+            || std::any_of(index_data_.cell_points.begin(), index_data_.cell_points.end(),
+                           [point_count](uint32_t point) { return point >= point_count; })) {
+            throw std::invalid_argument("Grid index doesn't match the points");
+        }
+        FillCellCoordinates(latitudes, longitudes);
+    }
+
+    void GridIndex::FillCellCoordinates(const std::vector<double> &latitudes, const std::vector<double> &longitudes) {
+        cell_latitudes_.clear();
+        cell_longitudes_.clear();
+        cell_latitudes_.reserve(index_data_.cell_points.size());
+        cell_longitudes_.reserve(index_data_.cell_points.size());
+        min_latitude_cos_ = 1.0;
+        for (const uint32_t point: index_data_.cell_points) {
+            cell_latitudes_.push_back(latitudes[point]);
+            cell_longitudes_.push_back(longitudes[point]);
+            min_latitude_cos_ = std::min(min_latitude_cos_, std::max(0.0, std::cos(latitudes[point] * DEGREE)));
+        }
+    }
+
+    template <typename OnRingScanned>
+    void GridIndex::ScanRings(Coordinates position, std::vector<Neighbour> &found,
+                              OnRingScanned on_ring_scanned) const {
+        const IndexData &data = index_data_;
+        if (data.cell_points.empty()) {
+            return;
+        }
+        const uint32_t position_row = ToCell(position.lat, data.min_latitude, data.cell_height, data.row_count);
+        const uint32_t position_column = ToCell(position.lng, data.min_longitude, data.cell_width,
+                                                data.column_count);
+
+        const auto scan_cell = [&](uint32_t row, uint32_t column) {
+            const size_t cell = static_cast<size_t>(row) * data.column_count + column;
+            for (size_t i = data.cell_offsets[cell]; i < data.cell_offsets[cell + 1]; ++i) {
+                found.push_back({data.cell_points[i],
+                                 ComputeDistance(position, {cell_latitudes_[i], cell_longitudes_[i]})});
+            }
+        };
+
+        //Points outside the scanned rows differ in latitude by at least latitude_gap, a lower bound of the
+        //distance for the points outside the scanned columns follows from the haversine formula:
+        //hav(d / R) >= cos(lat1) * cos(lat2) * hav(longitude difference)
+        const double max_longitude = data.min_longitude + data.column_count * data.cell_width;
+        const double widest_longitude_difference = std::max(std::abs(position.lng - data.min_longitude),
+                                                            std::abs(max_longitude - position.lng));
+        const double position_cos = std::max(0.0, std::cos(position.lat * DEGREE));
+        const auto get_bound = [&](double latitude_gap, double longitude_gap) {
+            const double latitude_bound = latitude_gap * DEGREE * EARTH_RADIUS;
+            double longitude_bound = INFINITE_DISTANCE;
+            if (longitude_gap != INFINITE_DISTANCE) {
+                //The way round the other side of the Earth may be shorter
+                const double difference = std::min({longitude_gap, 360.0 - widest_longitude_difference, 180.0});
+                longitude_bound = 2 * EARTH_RADIUS * std::asin(std::min(1.0, std::sqrt(position_cos * min_latitude_cos_)
+                                                                                 * std::sin(std::max(0.0, difference) * DEGREE / 2)));
+            }
+            return std::min(latitude_bound, longitude_bound) - DISTANCE_SLACK;
+        };
+
+        for (uint32_t ring = 0;; ++ring) {
+            const uint32_t first_row = position_row >= ring ? position_row - ring : 0;
+            const uint32_t last_row = std::min<uint64_t>(data.row_count - 1, uint64_t{position_row} + ring);
+            const uint32_t first_column = position_column >= ring ? position_column - ring : 0;
+            const uint32_t last_column = std::min<uint64_t>(data.column_count - 1, uint64_t{position_column} + ring);
+
+            for (uint32_t row = first_row; row <= last_row; ++row) {
+                if (row + ring == position_row || row == uint64_t{position_row} + ring) {
+                    for (uint32_t column = first_column; column <= last_column; ++column) {
+                        scan_cell(row, column);
+                    }
+                    continue;
+                }
+                if (position_column >= ring) {
+                    scan_cell(row, position_column - ring);
+                }
+                if (uint64_t{position_column} + ring < data.column_count) {
+                    scan_cell(row, position_column + ring);
+                }
+            }
+
+            double latitude_gap = INFINITE_DISTANCE;
+            if (first_row > 0) {
+                latitude_gap = std::max(0.0, position.lat - (data.min_latitude + first_row * data.cell_height));
+            }
+            if (last_row + 1 < data.row_count) {
+                latitude_gap = std::min(latitude_gap, std::max(0.0, data.min_latitude
+                                                                    + (last_row + 1) * data.cell_height - position.lat));
+            }
+            double longitude_gap = INFINITE_DISTANCE;
+            if (first_column > 0) {
+                longitude_gap = std::max(0.0, position.lng - (data.min_longitude + first_column * data.cell_width));
+            }
+            if (last_column + 1 < data.column_count) {
+                longitude_gap = std::min(longitude_gap, std::max(0.0, data.min_longitude
+                                                                      + (last_column + 1) * data.cell_width - position.lng));
+            }
+            if (latitude_gap == INFINITE_DISTANCE && longitude_gap == INFINITE_DISTANCE) {
+                return;
+            }
+            if (!on_ring_scanned(get_bound(latitude_gap, longitude_gap))) {
+                return;
+            }
+        }
+    }
+
+    std::vector<GridIndex::Neighbour> GridIndex::FindNearest(Coordinates position, size_t count) const {
+        std::vector<Neighbour> found;
+        if (count == 0) {
+            return found;
+        }
+        //Only the count closest points found so far are kept, the search goes on while a closer one may be left
+        ScanRings(position, found, [&found, count](double bound) {
+            if (found.size() < count) {
+                return true;
+            }
+            std::nth_element(found.begin(), found.begin() + (count - 1), found.end(), IsCloser);
+            found.resize(count);
+            return found.back().distance >= bound;
+        });
+        std::sort(found.begin(), found.end(), IsCloser);
+        if (found.size() > count) {
+            found.resize(count);
+        }
+        return found;
+    }
+
+    std::vector<GridIndex::Neighbour> GridIndex::FindInRadius(Coordinates position, double radius) const {
+        std::vector<Neighbour> found;
+        if (!(radius >= 0.0)) {
+            return found;
+        }
+        ScanRings(position, found, [radius](double bound) {
+            return bound <= radius;
+        });
+        found.erase(std::remove_if(found.begin(), found.end(), [radius](const Neighbour &neighbour) {
+            return neighbour.distance > radius;
+        }), found.end());
+        std::sort(found.begin(), found.end(), IsCloser);
+        return found;
+    }
+
+}
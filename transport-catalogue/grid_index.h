@@ -0,0 +1,76 @@
+#pragma once
+
+#include "geo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace geo {
+
+    //Points bucketed into a uniform latitude/longitude grid with cells of about the same size in meters.
+    //A query scans rings of cells around the cell of the position and stops as soon as no cell left
+    //can hold a point closer than the ones found, so it touches a few cells instead of all points.
+    class GridIndex {
+    public:
+
+        struct IndexData {
+            double min_latitude = 0.0;
+            double min_longitude = 0.0;
+            double cell_height = 1.0;       //degrees of latitude
+            double cell_width = 1.0;        //degrees of longitude
+            uint32_t row_count = 0;
+            uint32_t column_count = 0;
+            //Points of cell (row, column) are [cell_offsets[c], cell_offsets[c + 1]) of cell_points,
+            //c = row * column_count + column
+            std::vector<uint32_t> cell_offsets;
+            std::vector<uint32_t> cell_points;
+        };
+
+        //Point and its great-circle distance to the position in meters
+        struct Neighbour {
+            uint32_t point;
+            double distance;
+        };
+
+        GridIndex() = default;
+
+        //Point i is (latitudes[i], longitudes[i])
+        GridIndex(const std::vector<double> &latitudes, const std::vector<double> &longitudes);
+        GridIndex(const std::vector<double> &latitudes, const std::vector<double> &longitudes, IndexData index_data);
+
+        //Up to count closest points, both lists are ordered by distance, then by point
+        std::vector<Neighbour> FindNearest(Coordinates position, size_t count) const;
+        std::vector<Neighbour> FindInRadius(Coordinates position, double radius) const;
+
+        size_t GetPointCount() const {
+            return index_data_.cell_points.size();
+        }
+
+        const IndexData& GetIndexData() const {
+            return index_data_;
+        }
+
+    private:
+
+        static constexpr double POINTS_PER_CELL = 2.0;
+        //ComputeDistance loses precision on short distances, bounds are lowered by this many meters
+        static constexpr double DISTANCE_SLACK = 1.0;
+
+        //Calls on_ring_scanned(bound) after every ring of cells, bound is a lower bound of the distance to
+        //the points not scanned yet. Stops when it returns false or all cells are scanned.
+        template <typename OnRingScanned>
+        void ScanRings(Coordinates position, std::vector<Neighbour> &found, OnRingScanned on_ring_scanned) const;
+
+        void FillCellCoordinates(const std::vector<double> &latitudes, const std::vector<double> &longitudes);
+
+        IndexData index_data_;
+        //Coordinates in the order of cell_points
+        std::vector<double> cell_latitudes_;
+        std::vector<double> cell_longitudes_;
+        //The smallest cosine of the latitude among the points
+        double min_latitude_cos_ = 1.0;
+    };
+
+}
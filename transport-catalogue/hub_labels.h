@@ -0,0 +1,306 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "dijkstra_router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Hub labeling: every vertex keeps the weights of the routes to (out label) and from (in label)
+//a set of hubs, so that every route passes a hub found in the out label of its source and the
+//in label of its target. A route weight is a merge of two labels sorted by hub rank.
+//Labels are built by pruned searches from the hubs in order of their degree. Every entry keeps
+//the edge of its route next to the vertex, the vertex on the other side of the edge has an entry
+//of the same hub, so routes are unpacked by following the entries.
+template <typename Weight>
+class HubLabels final : public RouterBase<Weight> {
+private:
+
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+
+    using typename RouterBase<Weight>::RouteInfo;
+
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    struct LabelEntry {
+        uint32_t hub;       //rank of the hub
+        Weight weight;
+        EdgeId edge;        //first edge towards the hub in out labels, last edge from it in in labels
+    };
+
+    //Entries of vertex v are [offsets[v], offsets[v + 1]) sorted by hub
+    struct Labels {
+        std::vector<size_t> offsets;
+        std::vector<LabelEntry> entries;
+    };
+
+    struct LabelData {
+        Labels out_labels;
+        Labels in_labels;
+    };
+
+    explicit HubLabels(const Graph& graph);
+    HubLabels(const Graph& graph, LabelData label_data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const override;
+
+    const LabelData& GetLabelData() const {
+        return label_data_;
+    }
+
+private:
+
+    using LabelRange = std::pair<const LabelEntry*, const LabelEntry*>;
+
+    struct HubMatch {
+        Weight weight;
+        const LabelEntry* out_entry;
+        const LabelEntry* in_entry;
+    };
+
+    void BuildLabels();
+    void CheckLabels(const Labels& labels) const;
+    void CheckVertex(VertexId vertex) const;
+
+    static std::optional<HubMatch> FindBestHub(LabelRange out_label, LabelRange in_label);
+    static LabelRange GetLabel(const Labels& labels, VertexId vertex);
+    static const LabelEntry& FindEntry(const Labels& labels, VertexId vertex, uint32_t hub);
+
+    static constexpr Weight ZERO_WEIGHT{};
+
+    const Graph& graph_;
+    LabelData label_data_;
+};
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const Graph& graph)
+    : graph_(graph)
+{
+    for (const auto& edge : graph.GetEdges()) {
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    BuildLabels();
+}
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const Graph& graph, LabelData label_data)
+    : graph_(graph)
+    , label_data_(std::move(label_data))
+{
+    CheckLabels(label_data_.out_labels);
+    CheckLabels(label_data_.in_labels);
+}
+
+template <typename Weight>
+void HubLabels<Weight>::CheckLabels(const Labels& labels) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (labels.offsets.size() != vertex_count + 1 || labels.offsets.front() != 0
+        || labels.offsets.back() != labels.entries.size()) {
+        throw std::invalid_argument("Hub labels don't match the graph");
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (labels.offsets[vertex] > labels.offsets[vertex + 1]) {
+            throw std::invalid_argument("Hub labels don't match the graph");
+        }
+        for (size_t i = labels.offsets[vertex]; i < labels.offsets[vertex + 1]; ++i) {
+            const LabelEntry& entry = labels.entries[i];
+            if (entry.hub >= vertex_count || (entry.edge != NO_EDGE && entry.edge >= graph_.GetEdgeCount())
+                || (i > labels.offsets[vertex] && !(labels.entries[i - 1].hub < entry.hub))) {
+                throw std::invalid_argument("Hub labels don't match the graph");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void HubLabels<Weight>::BuildLabels() {
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    //Edges by target for the searches towards the hubs
+    std::vector<size_t> in_offsets(vertex_count + 1, 0);
+    for (const auto& edge : graph_.GetEdges()) {
+        ++in_offsets[edge.to + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        in_offsets[vertex + 1] += in_offsets[vertex];
+    }
+    std::vector<EdgeId> in_edges(graph_.GetEdgeCount());
+    {
+        std::vector<size_t> positions(in_offsets.begin(), in_offsets.end() - 1);
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            in_edges[positions[graph_.GetEdge(edge_id).to]++] = edge_id;
+        }
+    }
+
+    //Vertices with many edges cover many routes, they become hubs first
+    std::vector<VertexId> order(vertex_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](VertexId lhs, VertexId rhs) {
+        const size_t lhs_degree = graph_.GetEdgeOffsets()[lhs + 1] - graph_.GetEdgeOffsets()[lhs]
+                                  + in_offsets[lhs + 1] - in_offsets[lhs];
+        const size_t rhs_degree = graph_.GetEdgeOffsets()[rhs + 1] - graph_.GetEdgeOffsets()[rhs]
+                                  + in_offsets[rhs + 1] - in_offsets[rhs];
+        return lhs_degree > rhs_degree;
+    });
+
+    std::vector<std::vector<LabelEntry>> out_labels(vertex_count);
+    std::vector<std::vector<LabelEntry>> in_labels(vertex_count);
+    const auto as_range = [](const std::vector<LabelEntry>& label) {
+        return LabelRange{label.data(), label.data() + label.size()};
+    };
+
+    SearchScratch<Weight> scratch;
+    for (uint32_t rank = 0; rank < vertex_count; ++rank) {
+        const VertexId hub = order[rank];
+
+        //Routes from the hub, a vertex is pruned if the labels already know a route as short
+        scratch.Prepare(vertex_count);
+        scratch.Relax(hub, ZERO_WEIGHT, std::nullopt);
+        while (const auto vertex = scratch.PopNext()) {
+            const Weight weight = scratch.GetWeight(*vertex);
+            const auto known = FindBestHub(as_range(out_labels[hub]), as_range(in_labels[*vertex]));
+            if (known && !(weight < known->weight)) {
+                continue;
+            }
+            in_labels[*vertex].push_back({rank, weight, scratch.GetPrevEdge(*vertex).value_or(NO_EDGE)});
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(*vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                scratch.Relax(edge.to, weight + edge.weight, edge_id);
+            }
+        }
+
+        //Routes to the hub over the edges in reverse
+        scratch.Prepare(vertex_count);
+        scratch.Relax(hub, ZERO_WEIGHT, std::nullopt);
+        while (const auto vertex = scratch.PopNext()) {
+            const Weight weight = scratch.GetWeight(*vertex);
+            const auto known = FindBestHub(as_range(out_labels[*vertex]), as_range(in_labels[hub]));
+            if (known && !(weight < known->weight)) {
+                continue;
+            }
+            out_labels[*vertex].push_back({rank, weight, scratch.GetPrevEdge(*vertex).value_or(NO_EDGE)});
+            for (size_t i = in_offsets[*vertex]; i < in_offsets[*vertex + 1]; ++i) {
+                const auto& edge = graph_.GetEdge(in_edges[i]);
+                scratch.Relax(edge.from, weight + edge.weight, in_edges[i]);
+            }
+        }
+    }
+
+    const auto flatten = [vertex_count](std::vector<std::vector<LabelEntry>>& vertex_labels, Labels& labels) {
+        labels.offsets.assign(vertex_count + 1, 0);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            labels.offsets[vertex + 1] = labels.offsets[vertex] + vertex_labels[vertex].size();
+        }
+        labels.entries.reserve(labels.offsets.back());
+        for (auto& label : vertex_labels) {
+            labels.entries.insert(labels.entries.end(), label.begin(), label.end());
+            label = {};
+        }
+    };
+    flatten(out_labels, label_data_.out_labels);
+    flatten(in_labels, label_data_.in_labels);
+}
+
+template <typename Weight>
+void HubLabels<Weight>::CheckVertex(VertexId vertex) const {
+    if (vertex >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+}
+
+template <typename Weight>
+std::optional<typename HubLabels<Weight>::HubMatch> HubLabels<Weight>::FindBestHub(LabelRange out_label,
+                                                                                   LabelRange in_label) {
+    std::optional<HubMatch> best;
+    auto [out_it, out_end] = out_label;
+    auto [in_it, in_end] = in_label;
+    while (out_it != out_end && in_it != in_end) {
+        if (out_it->hub < in_it->hub) {
+            ++out_it;
+        } else if (in_it->hub < out_it->hub) {
+            ++in_it;
+        } else {
+            const Weight weight = out_it->weight + in_it->weight;
+            if (!best || weight < best->weight) {
+                best = HubMatch{weight, out_it, in_it};
+            }
+            ++out_it;
+            ++in_it;
+        }
+    }
+    return best;
+}
+
+template <typename Weight>
+typename HubLabels<Weight>::LabelRange HubLabels<Weight>::GetLabel(const Labels& labels, VertexId vertex) {
+    return {labels.entries.data() + labels.offsets[vertex], labels.entries.data() + labels.offsets[vertex + 1]};
+}
+
+template <typename Weight>
+const typename HubLabels<Weight>::LabelEntry& HubLabels<Weight>::FindEntry(const Labels& labels, VertexId vertex,
+                                                                          uint32_t hub) {
+    const auto [begin, end] = GetLabel(labels, vertex);
+    const LabelEntry* entry = std::lower_bound(begin, end, hub, [](const LabelEntry& lhs, uint32_t rank) {
+        return lhs.hub < rank;
+    });
+    if (entry == end || entry->hub != hub) {
+        throw std::logic_error("Hub labels are inconsistent");
+    }
+    return *entry;
+}
+
+template <typename Weight>
+std::optional<Weight> HubLabels<Weight>::GetRouteWeight(VertexId from, VertexId to) const {
+    CheckVertex(from);
+    CheckVertex(to);
+    const auto match = FindBestHub(GetLabel(label_data_.out_labels, from), GetLabel(label_data_.in_labels, to));
+    if (!match) {
+        return std::nullopt;
+    }
+    return match->weight;
+}
+
+template <typename Weight>
+std::optional<typename HubLabels<Weight>::RouteInfo> HubLabels<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    CheckVertex(from);
+    CheckVertex(to);
+    const auto match = FindBestHub(GetLabel(label_data_.out_labels, from), GetLabel(label_data_.in_labels, to));
+    if (!match) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (const LabelEntry* entry = match->out_entry; entry->edge != NO_EDGE;) {
+        edges.push_back(entry->edge);
+        entry = &FindEntry(label_data_.out_labels, graph_.GetEdge(entry->edge).to, entry->hub);
+    }
+    const size_t first_in_edge = edges.size();
+    for (const LabelEntry* entry = match->in_entry; entry->edge != NO_EDGE;) {
+        edges.push_back(entry->edge);
+        entry = &FindEntry(label_data_.in_labels, graph_.GetEdge(entry->edge).from, entry->hub);
+    }
+    std::reverse(edges.begin() + first_in_edge, edges.end());
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
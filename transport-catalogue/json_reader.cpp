@@ -1,4 +1,8 @@
+#include <cmath>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include "json_reader.h"
 
 namespace json_reader {
@@ -16,11 +20,13 @@ namespace json_reader {
         ReadSerializationSettings();
         ParseStop();
         ParseBus();
+        tc_.ComputeBusStats();
+        tc_.BuildStopIndex();
 
         renderer::RenderSettings renderSettings = ReadRenderSettings();
         mr_.SetRendererSettings(renderSettings);
 
-        domain::RouteSettings route_settings = ReadRouteSettings();
+        domain::RouteSettings route_settings = ReadRouteSettings(domain::RouteSettings{});
         tr_.RouteInit(route_settings);
 
     }
@@ -47,6 +53,8 @@ namespace json_reader {
                 tc_.AddStop(stop_name, {latitude, longitude});
             }
         }
+        //Ids are final before the distances and the buses refer to them, the base keeps the order
+        tc_.SortStopsByLocation();
 
         for (const auto &request: requests) {
             if (request.AsDict().at("type"s) == "Stop"s) {
@@ -55,10 +63,11 @@ namespace json_reader {
                 const auto &stop_distance = request_map.at("road_distances"s).AsDict();
                 for (auto [second_stop, real_distance]: stop_distance) {
                     tc_.SetDistanceStops(tc_.FindStop(first_stop), tc_.FindStop(second_stop),
-                                         real_distance.AsDouble());
+                                         static_cast<uint32_t>(std::llround(real_distance.AsDouble())));
                 }
             }
         }
+        tc_.FreezeDistances();
     }
 
     void JsonReader::ParseBus() {
@@ -85,10 +94,20 @@ namespace json_reader {
         using namespace std::string_literals;
         RequestHandler handler(tc_, mr_, tr_);
 
+        //routing_settings of process_requests override the ones of the base without make_base
+        if (input_.GetRoot().AsDict().count("routing_settings"s)) {
+            tr_.UpdateRouteSettings(ReadRouteSettings(tr_.GetRouteSettings()));
+        }
+
         json::Array result;
         auto requests = input_.GetRoot().AsDict().at("stat_requests"s).AsArray();
 
-        for (const auto request: requests) {
+        //Route requests are answered per origin after the others, answers keep the order of the requests
+        std::unordered_map<std::string, std::vector<std::pair<const json::Node*, size_t>>> routes_by_origin;
+        //Matrix answers by their position, they are printed without a node per cell
+        std::unordered_map<size_t, RequestHandler::TimeMatrix> matrices;
+
+        for (const auto &request: requests) {
             std::string type = request.AsDict().at("type"s).AsString();
             if (type == "Bus"s) {
                 result.push_back(std::move(handler.GetBus(request)));
@@ -99,13 +118,55 @@ namespace json_reader {
             if (type == "Map"s) {
                 result.push_back(std::move(handler.GetMap(request)));
             }
-            if (type == "Route"s) {
+            if (type == "Matrix"s) {
+                matrices.emplace(result.size(), handler.GetMatrix(request));
+                result.emplace_back();
+            }
+            if (type == "Isochrone"s) {
+                result.push_back(std::move(handler.GetIsochrone(request)));
+            }
+            if (type == "NearestStops"s) {
+                result.push_back(std::move(handler.GetNearestStops(request)));
+            }
+            if (type == "StopsInRadius"s) {
+                result.push_back(std::move(handler.GetStopsInRadius(request)));
+            }
+            if (type == "RouteTime"s) {
+                result.push_back(std::move(handler.GetRouteTime(request)));
+            }
+            if (type == "Route"s && (RequestHandler::HasRouteSettings(request)
+                                     || RequestHandler::HasTransferOptions(request))) {
                 result.push_back(std::move(handler.GetRoute(request)));
+            } else if (type == "Route"s) {
+                routes_by_origin[request.AsDict().at("from"s).AsString()].push_back({&request, result.size()});
+                result.emplace_back();
+            }
+        }
+
+        for (const auto &[_, origin_routes]: routes_by_origin) {
+            std::vector<const json::Node*> origin_requests;
+            origin_requests.reserve(origin_routes.size());
+            for (const auto &route: origin_routes) {
+                origin_requests.push_back(route.first);
+            }
+            auto answers = handler.GetRoutes(origin_requests);
+            for (size_t i = 0; i < origin_routes.size(); ++i) {
+                result[origin_routes[i].second] = std::move(answers[i]);
             }
         }
 
-        json::Document doc(std::move(result));
-        json::Print(doc, out);
+        out << "["s;
+        for (size_t i = 0; i < result.size(); ++i) {
+            if (i > 0) {
+                out << ", "s;
+            }
+            if (const auto matrix = matrices.find(i); matrix != matrices.end()) {
+                RequestHandler::PrintMatrix(matrix->second, out);
+            } else {
+                json::PrintNode(result[i], out);
+            }
+        }
+        out << "]"s;
     }
 
     renderer::RenderSettings JsonReader::ReadRenderSettings() {
@@ -157,15 +218,71 @@ namespace json_reader {
         return render_settings;
     }
 
-    domain::RouteSettings JsonReader::ReadRouteSettings() {
+    domain::RouteSettings JsonReader::ReadRouteSettings(domain::RouteSettings setting) {
         using namespace std::string_literals;
-        domain::RouteSettings setting;
         json::Dict route_settings = input_.GetRoot().AsDict().at("routing_settings"s).AsDict();
-        setting.bus_wait_time = route_settings.at("bus_wait_time"s).AsInt();
-        setting.bus_velocity = route_settings.at("bus_velocity"s).AsDouble();
+        if (route_settings.count("bus_wait_time"s)) {
+            setting.bus_wait_time = route_settings.at("bus_wait_time"s).AsInt();
+        }
+        if (route_settings.count("bus_velocity"s)) {
+            setting.bus_velocity = route_settings.at("bus_velocity"s).AsDouble();
+        }
+        if (route_settings.count("router_engine"s)) {
+            setting.router_engine = ReadRouterEngine(route_settings.at("router_engine"s).AsString());
+        }
+        if (route_settings.count("graph_model"s)) {
+            setting.graph_model = ReadGraphModel(route_settings.at("graph_model"s).AsString());
+        }
+        if (route_settings.count("route_cache_size"s)) {
+            const int route_cache_size = route_settings.at("route_cache_size"s).AsInt();
+            if (route_cache_size < 0) {
+                throw std::invalid_argument("route_cache_size should be non-negative");
+            }
+            setting.route_cache_size = static_cast<size_t>(route_cache_size);
+        }
         return setting;
     }
 
+    domain::RouterEngine JsonReader::ReadRouterEngine(const std::string &engine_name) {
+        using namespace std::string_literals;
+        if (engine_name == "all_pairs"s) {
+            return domain::RouterEngine::ALL_PAIRS;
+        }
+        if (engine_name == "dijkstra"s) {
+            return domain::RouterEngine::DIJKSTRA;
+        }
+        if (engine_name == "compact_all_pairs"s) {
+            return domain::RouterEngine::COMPACT_ALL_PAIRS;
+        }
+        if (engine_name == "contraction_hierarchies"s) {
+            return domain::RouterEngine::CONTRACTION_HIERARCHIES;
+        }
+        if (engine_name == "a_star"s) {
+            return domain::RouterEngine::A_STAR;
+        }
+        if (engine_name == "multi_level_overlay"s) {
+            return domain::RouterEngine::MULTI_LEVEL_OVERLAY;
+        }
+        if (engine_name == "hub_labels"s) {
+            return domain::RouterEngine::HUB_LABELS;
+        }
+        if (engine_name == "all_pairs_search"s) {
+            return domain::RouterEngine::ALL_PAIRS_SEARCH;
+        }
+        throw std::invalid_argument("Unknown router engine: "s + engine_name);
+    }
+
+    domain::GraphModel JsonReader::ReadGraphModel(const std::string &model_name) {
+        using namespace std::string_literals;
+        if (model_name == "complete"s) {
+            return domain::GraphModel::COMPLETE;
+        }
+        if (model_name == "expanded"s) {
+            return domain::GraphModel::EXPANDED;
+        }
+        throw std::invalid_argument("Unknown graph model: "s + model_name);
+    }
+
     void JsonReader::ReadSerializationSettings() {
         using namespace std::string_literals;
         json::Dict serialization_settings = input_.GetRoot().AsDict().at("serialization_settings"s).AsDict();
@@ -36,7 +36,10 @@ namespace json_reader {
         void ParseBus();
 
         renderer::RenderSettings ReadRenderSettings();
-        domain::RouteSettings ReadRouteSettings();
+        //Settings present in routing_settings replace the ones of setting
+        domain::RouteSettings ReadRouteSettings(domain::RouteSettings setting);
+        static domain::RouterEngine ReadRouterEngine(const std::string &engine_name);
+        static domain::GraphModel ReadGraphModel(const std::string &model_name);
 
         void ReadSerializationSettings();
     };
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+    struct CacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    //Bounded least-recently-used cache, all methods may be called from several threads.
+    //Capacity 0 disables the cache, lookups then neither hit nor count as misses.
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    class LruCache {
+    public:
+        explicit LruCache(size_t capacity = 0)
+                : capacity_(capacity) {}
+
+        std::optional<Value> Get(const Key &key) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (capacity_ == 0) {
+                return std::nullopt;
+            }
+            auto it = positions_.find(key);
+            if (it == positions_.end()) {
+                ++misses_;
+                return std::nullopt;
+            }
+            ++hits_;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->second;
+        }
+
+        void Put(const Key &key, Value value) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (capacity_ == 0) {
+                return;
+            }
+            auto it = positions_.find(key);
+            if (it != positions_.end()) {
+                it->second->second = std::move(value);
+                entries_.splice(entries_.begin(), entries_, it->second);
+                return;
+            }
+            entries_.emplace_front(key, std::move(value));
+            positions_[key] = entries_.begin();
+            EvictOverflow();
+        }
+
+        void SetCapacity(size_t capacity) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            capacity_ = capacity;
+            EvictOverflow();
+        }
+
+        //Drops the entries, counters are kept
+        void Clear() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.clear();
+            positions_.clear();
+        }
+
+        CacheStats GetStats() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return {hits_, misses_, entries_.size(), capacity_};
+        }
+
+    private:
+        using Entries = std::list<std::pair<Key, Value>>;
+
+        void EvictOverflow() {
+            while (entries_.size() > capacity_) {
+                positions_.erase(entries_.back().first);
+                entries_.pop_back();
+            }
+        }
+
+        mutable std::mutex mutex_;
+        size_t capacity_;
+        Entries entries_;
+        std::unordered_map<Key, typename Entries::iterator, Hash> positions_;
+        size_t hits_ = 0;
+        size_t misses_ = 0;
+    };
+
+}
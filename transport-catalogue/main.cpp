@@ -1,13 +1,17 @@
+#include <cctype>
 #include <iostream>
 #include <fstream>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <stdexcept>
 
 #include <transport_catalogue.pb.h>
 
 #include "json.h"
 #include "json_reader.h"
 #include "map_renderer.h"
+#include "parallel.h"
 #include "transport_router.h"
 #include "serialization.h"
 
@@ -15,14 +19,40 @@
 using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|process_requests] [--threads N]\n"sv;
+}
+
+//Whole decimal number in [1, parallel::MAX_THREAD_COUNT], stoul alone would skip spaces and wrap "-1" around
+std::optional<size_t> ParseThreadCount(const std::string& argument) {
+    if (argument.empty() || !std::isdigit(static_cast<unsigned char>(argument.front()))) {
+        return std::nullopt;
+    }
+    size_t thread_count = 0;
+    size_t pos = 0;
+    try {
+        thread_count = std::stoul(argument, &pos);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    if (pos != argument.size() || thread_count == 0 || thread_count > parallel::MAX_THREAD_COUNT) {
+        return std::nullopt;
+    }
+    return thread_count;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
+    if (argc != 2 && argc != 4) {
         PrintUsage();
         return 1;
     }
+    if (argc == 4) {
+        const auto thread_count = ParseThreadCount(argv[3]);
+        if (argv[2] != "--threads"sv || !thread_count) {
+            PrintUsage();
+            return 1;
+        }
+        parallel::SetThreadCount(*thread_count);
+    }
 
     transport_catalogue::TransportCatalogue tc;
     renderer::MapRenderer mr;
@@ -0,0 +1,379 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "dijkstra_router.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Customizable route planning over a multi-level partition of the vertices. Level 0 has the smallest
+//cells and every cell lies inside one cell of the next level. The partition depends on the topology
+//only, the customization computes the routes between the boundary vertices of every cell (its clique)
+//from the current weights, the cells of one level in parallel. A query uses the graph's edges inside
+//the cells of the source and the target only and crosses the other cells by their cliques, the cell
+//of the highest level that contains neither of them is used. Clique arcs are unpacked by a search
+//inside their cell.
+//Arc ids below GetEdgeCount() are graph edges, the others are clique arcs.
+template <typename Weight>
+class MultiLevelOverlay final : public RouterBase<Weight> {
+private:
+
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+
+    using typename RouterBase<Weight>::RouteInfo;
+    //partition[level][vertex] is the cell of the vertex, cell ids are below the vertex count
+    using Partition = std::vector<std::vector<uint32_t>>;
+
+    MultiLevelOverlay(const Graph& graph, Partition partition, size_t thread_count = parallel::GetThreadCount());
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    const Partition& GetPartition() const {
+        return partition_;
+    }
+
+private:
+
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+    struct Cell {
+        std::vector<VertexId> entries;                  //vertices with an edge coming from another cell
+        std::vector<VertexId> exits;                    //vertices with an edge leading to another cell
+        std::vector<std::optional<Weight>> clique;      //entries x exits in row-major order
+        EdgeId first_arc = 0;                           //arc id of clique[0]
+    };
+
+    struct Level {
+        std::vector<Cell> cells;
+        std::vector<uint32_t> entry_indexes;            //index of the vertex in the entries of its cell
+        EdgeId arcs_end = 0;
+    };
+
+    struct ArcLocation {
+        size_t level;
+        uint32_t cell_id;
+        size_t clique_index;
+    };
+
+    void CheckPartition() const;
+    void BuildLevels();
+    void Customize(size_t thread_count);
+    void CustomizeCell(size_t level, uint32_t cell_id, SearchScratch<Weight>& scratch);
+
+    //Arcs of the vertex on the overlay level: graph edges on level 0, on level l the clique of the vertex's
+    //cell of partition level l - 1 and the edges leaving that cell
+    template <typename Callback>
+    void ForEachArc(size_t level, VertexId vertex, Callback callback) const;
+    size_t GetQueryLevel(VertexId vertex, VertexId from, VertexId to) const;
+
+    ArcLocation LocateArc(EdgeId arc_id) const;
+    VertexId GetArcSource(EdgeId arc_id) const;
+    void UnpackArc(EdgeId arc_id, SearchScratch<Weight>& scratch, std::vector<EdgeId>& edges) const;
+
+    static SearchScratch<Weight>& GetScratch() {
+        thread_local SearchScratch<Weight> scratch;
+        return scratch;
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+
+    const Graph& graph_;
+    Partition partition_;
+    std::vector<Level> levels_;
+};
+
+template <typename Weight>
+MultiLevelOverlay<Weight>::MultiLevelOverlay(const Graph& graph, Partition partition, size_t thread_count)
+    : graph_(graph)
+    , partition_(std::move(partition))
+{
+    for (const auto& edge : graph.GetEdges()) {
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    CheckPartition();
+    BuildLevels();
+    Customize(thread_count);
+}
+
+template <typename Weight>
+void MultiLevelOverlay<Weight>::CheckPartition() const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (size_t level = 0; level < partition_.size(); ++level) {
+        const auto& cell_ids = partition_[level];
+        if (cell_ids.size() != vertex_count) {
+            throw std::invalid_argument("Partition doesn't match the graph");
+        }
+        if (std::any_of(cell_ids.begin(), cell_ids.end(), [vertex_count](uint32_t cell_id) {
+                return cell_id >= vertex_count;
+            })) {
+            throw std::invalid_argument("Cell id is out of range");
+        }
+        if (level == 0) {
+            continue;
+        }
+        std::vector<uint32_t> parent_cells(vertex_count, NO_ENTRY);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            uint32_t& parent_cell = parent_cells[partition_[level - 1][vertex]];
+            if (parent_cell == NO_ENTRY) {
+                parent_cell = cell_ids[vertex];
+            } else if (parent_cell != cell_ids[vertex]) {
+                throw std::invalid_argument("Cells of the partition levels should be nested");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void MultiLevelOverlay<Weight>::BuildLevels() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    EdgeId next_arc = graph_.GetEdgeCount();
+    levels_.assign(partition_.size(), Level{});
+
+    for (size_t level_index = 0; level_index < partition_.size(); ++level_index) {
+        const auto& cell_ids = partition_[level_index];
+        Level& level = levels_[level_index];
+
+        std::vector<bool> is_entry(vertex_count, false);
+        std::vector<bool> is_exit(vertex_count, false);
+        for (const auto& edge : graph_.GetEdges()) {
+            if (cell_ids[edge.from] != cell_ids[edge.to]) {
+                is_exit[edge.from] = true;
+                is_entry[edge.to] = true;
+            }
+        }
+
+        const uint32_t cell_count = vertex_count == 0 ? 0 : *std::max_element(cell_ids.begin(), cell_ids.end()) + 1;
+        level.cells.resize(cell_count);
+        level.entry_indexes.assign(vertex_count, NO_ENTRY);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            Cell& cell = level.cells[cell_ids[vertex]];
+            if (is_entry[vertex]) {
+                level.entry_indexes[vertex] = static_cast<uint32_t>(cell.entries.size());
+                cell.entries.push_back(vertex);
+            }
+            if (is_exit[vertex]) {
+                cell.exits.push_back(vertex);
+            }
+        }
+
+        for (Cell& cell : level.cells) {
+            cell.first_arc = next_arc;
+            next_arc += cell.entries.size() * cell.exits.size();
+        }
+        level.arcs_end = next_arc;
+    }
+}
+
+template <typename Weight>
+void MultiLevelOverlay<Weight>::Customize(size_t thread_count) {
+    //A level's cliques are built from the cliques of the level below
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        const size_t cell_count = levels_[level].cells.size();
+        std::atomic<size_t> next_cell{0};
+        parallel::RunOnThreads(std::max<size_t>(1, std::min(thread_count, cell_count)), [&](size_t) {
+            SearchScratch<Weight> scratch;
+            for (size_t cell_id = next_cell++; cell_id < cell_count; cell_id = next_cell++) {
+                CustomizeCell(level, static_cast<uint32_t>(cell_id), scratch);
+            }
+        });
+    }
+}
+
+template <typename Weight>
+void MultiLevelOverlay<Weight>::CustomizeCell(size_t level, uint32_t cell_id, SearchScratch<Weight>& scratch) {
+    const auto& cell_ids = partition_[level];
+    Cell& cell = levels_[level].cells[cell_id];
+    const size_t exit_count = cell.exits.size();
+    cell.clique.assign(cell.entries.size() * exit_count, std::nullopt);
+    if (exit_count == 0) {
+        return;
+    }
+
+    for (size_t entry_index = 0; entry_index < cell.entries.size(); ++entry_index) {
+        scratch.Prepare(graph_.GetVertexCount());
+        scratch.Relax(cell.entries[entry_index], ZERO_WEIGHT, std::nullopt);
+        while (const auto vertex = scratch.PopNext()) {
+            const Weight& weight = scratch.GetWeight(*vertex);
+            ForEachArc(level, *vertex, [&](VertexId next, const Weight& arc_weight, EdgeId) {
+                if (cell_ids[next] == cell_id) {
+                    scratch.Relax(next, weight + arc_weight, std::nullopt);
+                }
+            });
+        }
+        for (size_t exit_index = 0; exit_index < exit_count; ++exit_index) {
+            if (scratch.IsSettled(cell.exits[exit_index])) {
+                cell.clique[entry_index * exit_count + exit_index] = scratch.GetWeight(cell.exits[exit_index]);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+template <typename Callback>
+void MultiLevelOverlay<Weight>::ForEachArc(size_t level, VertexId vertex, Callback callback) const {
+    if (level == 0) {
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            callback(edge.to, edge.weight, edge_id);
+        }
+        return;
+    }
+
+    const auto& cell_ids = partition_[level - 1];
+    const Level& cell_level = levels_[level - 1];
+    const uint32_t entry_index = cell_level.entry_indexes[vertex];
+    if (entry_index != NO_ENTRY) {
+        const Cell& cell = cell_level.cells[cell_ids[vertex]];
+        const size_t exit_count = cell.exits.size();
+        for (size_t exit_index = 0; exit_index < exit_count; ++exit_index) {
+            const size_t clique_index = entry_index * exit_count + exit_index;
+            if (const auto& weight = cell.clique[clique_index]) {
+                callback(cell.exits[exit_index], *weight, cell.first_arc + clique_index);
+            }
+        }
+    }
+    for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (cell_ids[edge.to] != cell_ids[vertex]) {
+            callback(edge.to, edge.weight, edge_id);
+        }
+    }
+}
+
+template <typename Weight>
+size_t MultiLevelOverlay<Weight>::GetQueryLevel(VertexId vertex, VertexId from, VertexId to) const {
+    //Cells are nested, so a vertex outside the cells of the source and the target on some level
+    //is outside them on every level below
+    size_t level = 0;
+    while (level < partition_.size()
+           && partition_[level][vertex] != partition_[level][from]
+           && partition_[level][vertex] != partition_[level][to]) {
+        ++level;
+    }
+    return level;
+}
+
+template <typename Weight>
+typename MultiLevelOverlay<Weight>::ArcLocation MultiLevelOverlay<Weight>::LocateArc(EdgeId arc_id) const {
+    size_t level = 0;
+    while (arc_id >= levels_[level].arcs_end) {
+        ++level;
+    }
+    const auto& cells = levels_[level].cells;
+    //Cells without arcs share first_arc with the next cell, so the last cell starting at or before the arc holds it
+    const auto cell_it = std::upper_bound(cells.begin(), cells.end(), arc_id, [](EdgeId arc, const Cell& cell) {
+        return arc < cell.first_arc;
+    }) - 1;
+    return {level, static_cast<uint32_t>(cell_it - cells.begin()), arc_id - cell_it->first_arc};
+}
+
+template <typename Weight>
+VertexId MultiLevelOverlay<Weight>::GetArcSource(EdgeId arc_id) const {
+    if (arc_id < graph_.GetEdgeCount()) {
+        return graph_.GetEdge(arc_id).from;
+    }
+    const ArcLocation location = LocateArc(arc_id);
+    const Cell& cell = levels_[location.level].cells[location.cell_id];
+    return cell.entries[location.clique_index / cell.exits.size()];
+}
+
+template <typename Weight>
+void MultiLevelOverlay<Weight>::UnpackArc(EdgeId arc_id, SearchScratch<Weight>& scratch,
+                                          std::vector<EdgeId>& edges) const {
+    if (arc_id < graph_.GetEdgeCount()) {
+        edges.push_back(arc_id);
+        return;
+    }
+
+    const ArcLocation location = LocateArc(arc_id);
+    const auto& cell_ids = partition_[location.level];
+    const Cell& cell = levels_[location.level].cells[location.cell_id];
+    const VertexId from = cell.entries[location.clique_index / cell.exits.size()];
+    const VertexId to = cell.exits[location.clique_index % cell.exits.size()];
+
+    scratch.Prepare(graph_.GetVertexCount());
+    scratch.Relax(from, ZERO_WEIGHT, std::nullopt);
+    while (const auto vertex = scratch.PopNext()) {
+        if (*vertex == to) {
+            break;
+        }
+        const Weight& weight = scratch.GetWeight(*vertex);
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(*vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (cell_ids[edge.to] == location.cell_id) {
+                scratch.Relax(edge.to, weight + edge.weight, edge_id);
+            }
+        }
+    }
+
+    //The clique arc exists only if the exit is reachable inside the cell
+    const size_t first_edge = edges.size();
+    for (std::optional<EdgeId> edge_id = scratch.GetPrevEdge(to);
+         edge_id;
+         edge_id = scratch.GetPrevEdge(graph_.GetEdge(*edge_id).from))
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin() + first_edge, edges.end());
+}
+
+template <typename Weight>
+std::optional<typename MultiLevelOverlay<Weight>::RouteInfo> MultiLevelOverlay<Weight>::BuildRoute(VertexId from,
+                                                                                                   VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    SearchScratch<Weight>& scratch = GetScratch();
+    scratch.Prepare(vertex_count);
+    scratch.Relax(from, ZERO_WEIGHT, std::nullopt);
+
+    while (const auto vertex = scratch.PopNext()) {
+        if (*vertex == to) {
+            break;
+        }
+        const Weight& weight = scratch.GetWeight(*vertex);
+        ForEachArc(GetQueryLevel(*vertex, from, to), *vertex, [&](VertexId next, const Weight& arc_weight, EdgeId arc_id) {
+            scratch.Relax(next, weight + arc_weight, arc_id);
+        });
+    }
+
+    if (!scratch.IsSettled(to)) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> arcs;
+    for (auto arc_id = scratch.GetPrevEdge(to); arc_id; arc_id = scratch.GetPrevEdge(GetArcSource(*arc_id))) {
+        arcs.push_back(*arc_id);
+    }
+    std::reverse(arcs.begin(), arcs.end());
+
+    //The search state isn't needed anymore, so the scratch is reused to unpack the cliques
+    std::vector<EdgeId> edges;
+    for (const EdgeId arc_id : arcs) {
+        UnpackArc(arc_id, scratch, edges);
+    }
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
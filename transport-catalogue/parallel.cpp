@@ -0,0 +1,82 @@
+#include "parallel.h"
+
+#include <atomic>
+
+namespace parallel {
+
+    namespace {
+        std::atomic<size_t> configured_thread_count{0};
+    }
+
+    size_t GetThreadCount() {
+        if (const size_t thread_count = configured_thread_count) {
+            return thread_count;
+        }
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        return hardware_threads > 0 ? hardware_threads : 1;
+    }
+
+    void SetThreadCount(size_t thread_count) {
+        configured_thread_count = thread_count;
+    }
+
+    Barrier::Barrier(size_t thread_count, std::function<void()> on_completion)
+            : thread_count_(thread_count), on_completion_(std::move(on_completion)) {}
+
+    void Barrier::ArriveAndWait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const size_t generation = generation_;
+        if (++arrived_ == thread_count_) {
+            if (on_completion_) {
+                on_completion_();
+            }
+            arrived_ = 0;
+            ++generation_;
+            lock.unlock();
+            released_.notify_all();
+            return;
+        }
+        released_.wait(lock, [this, generation]() {
+            return generation != generation_;
+        });
+    }
+
+    WorkStealingQueue::WorkStealingQueue(size_t task_count, size_t thread_count)
+            : blocks_(thread_count) {
+        for (size_t i = 0; i < thread_count; ++i) {
+            blocks_[i].begin = task_count * i / thread_count;
+            blocks_[i].end = task_count * (i + 1) / thread_count;
+        }
+    }
+
+    std::optional<size_t> WorkStealingQueue::Pop(size_t thread_index) {
+        Block &own = blocks_[thread_index];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin < own.end) {
+                return own.begin++;
+            }
+        }
+        //Only the owner refills its block, so it stays empty until the stolen tasks are stored
+        for (size_t i = 1; i < blocks_.size(); ++i) {
+            Block &victim = blocks_[(thread_index + i) % blocks_.size()];
+            size_t stolen_begin = 0;
+            size_t stolen_end = 0;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.begin == victim.end) {
+                    continue;
+                }
+                stolen_begin = victim.begin + (victim.end - victim.begin) / 2;
+                stolen_end = victim.end;
+                victim.end = stolen_begin;
+            }
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = stolen_begin + 1;
+            own.end = stolen_end;
+            return stolen_begin;
+        }
+        return std::nullopt;
+    }
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+    //Thread counts above it are rejected on the command line
+    inline constexpr size_t MAX_THREAD_COUNT = 256;
+
+    //Hardware concurrency unless set explicitly, 0 restores the default
+    size_t GetThreadCount();
+    void SetThreadCount(size_t thread_count);
+
+    //Reusable barrier, the last arriving thread runs on_completion before the others are released
+    class Barrier {
+    public:
+        explicit Barrier(size_t thread_count, std::function<void()> on_completion = {});
+
+        void ArriveAndWait();
+
+    private:
+        const size_t thread_count_;
+        const std::function<void()> on_completion_;
+
+        std::mutex mutex_;
+        std::condition_variable released_;
+        size_t arrived_ = 0;
+        size_t generation_ = 0;
+    };
+
+    //Task indexes [0, task_count) split into one block per thread. A thread takes its tasks from the front
+    //of its block, a thread out of tasks steals the back half of the first non-empty block of the others.
+    class WorkStealingQueue {
+    public:
+        WorkStealingQueue(size_t task_count, size_t thread_count);
+
+        std::optional<size_t> Pop(size_t thread_index);
+
+    private:
+        struct Block {
+            std::mutex mutex;
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
+        std::vector<Block> blocks_;
+    };
+
+    //Calls worker(thread_index) on thread_count threads, the calling thread is one of them
+    template <typename Worker>
+    void RunOnThreads(size_t thread_count, Worker worker) {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count > 0 ? thread_count - 1 : 0);
+        for (size_t thread_index = 1; thread_index < thread_count; ++thread_index) {
+            threads.emplace_back([&worker, thread_index]() {
+                worker(thread_index);
+            });
+        }
+        worker(0);
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+
+    //Calls task(thread_index, task_index) for every task index of [0, task_count) on up to thread_count threads
+    template <typename Task>
+    void RunStealingTasks(size_t task_count, size_t thread_count, Task task) {
+        thread_count = std::max<size_t>(1, std::min(thread_count, task_count));
+        WorkStealingQueue queue(task_count, thread_count);
+        RunOnThreads(thread_count, [&queue, &task](size_t thread_index) {
+            while (const auto task_index = queue.Pop(thread_index)) {
+                task(thread_index, *task_index);
+            }
+        });
+    }
+
+}
@@ -0,0 +1,160 @@
+#include "raptor_router.h"
+#include <algorithm>
+#include <limits>
+
+namespace transport_router {
+
+    RaptorRouter::RaptorRouter(const transport_catalogue::TransportCatalogue &catalogue)
+            : stops_(catalogue.GetStopBase()) {
+        for (const auto &[_, bus]: catalogue.GetAllBusesInfo()) {
+            if (bus->bus_stops.size() < 2) {
+                continue;
+            }
+            AddPattern(catalogue, bus, true);
+            if (!bus->is_circle) {
+                AddPattern(catalogue, bus, false);
+            }
+        }
+
+        //Counting sort of the pattern positions by stop
+        stop_pattern_offsets_.assign(stops_.size() + 1, 0);
+        for (const auto &pattern: patterns_) {
+            for (const uint32_t stop: pattern.stops) {
+                ++stop_pattern_offsets_[stop + 1];
+            }
+        }
+        for (size_t stop = 0; stop < stops_.size(); ++stop) {
+            stop_pattern_offsets_[stop + 1] += stop_pattern_offsets_[stop];
+        }
+        std::vector<size_t> positions(stop_pattern_offsets_.begin(), stop_pattern_offsets_.end() - 1);
+        stop_patterns_.resize(stop_pattern_offsets_.back());
+        for (uint32_t pattern = 0; pattern < patterns_.size(); ++pattern) {
+            const auto &stops = patterns_[pattern].stops;
+            for (uint32_t position = 0; position < stops.size(); ++position) {
+                stop_patterns_[positions[stops[position]]++] = {pattern, position};
+            }
+        }
+    }
+
+    void RaptorRouter::AddPattern(const transport_catalogue::TransportCatalogue &catalogue, domain::BusPtr bus,
+                                  bool is_forward) {
+        Pattern pattern;
+        pattern.bus = bus;
+        const size_t stops_count = bus->bus_stops.size();
+        pattern.stops.reserve(stops_count);
+        pattern.distances.reserve(stops_count);
+        for (size_t k = 0; k < stops_count; ++k) {
+            const domain::StopPtr stop = bus->bus_stops[is_forward ? k : stops_count - 1 - k];
+            pattern.distances.push_back(k == 0 ? 0 : pattern.distances.back()
+                                                     + catalogue.GetDistance(stops_[pattern.stops.back()], stop));
+            pattern.stops.push_back(stop->id);
+        }
+        patterns_.push_back(std::move(pattern));
+    }
+
+    std::vector<RaptorJourney> RaptorRouter::FindJourneys(domain::StopPtr from, domain::StopPtr to,
+                                                          size_t max_bus_count, double bus_velocity,
+                                                          double bus_wait_time) const {
+        if (from == to) {
+            return {RaptorJourney{}};
+        }
+        const uint32_t source = from->id;
+        const uint32_t target = to->id;
+        const double unreached = std::numeric_limits<double>::infinity();
+
+        //arrivals[k][s] is the fastest journey to s with at most k buses
+        std::vector<std::vector<double>> arrivals{std::vector<double>(stops_.size(), unreached)};
+        std::vector<std::vector<Parent>> parents{std::vector<Parent>(stops_.size())};
+        arrivals[0][source] = 0.0;
+
+        std::vector<uint32_t> marked_stops{source};
+        std::vector<bool> is_marked(stops_.size(), false);
+        std::vector<uint32_t> first_positions(patterns_.size(), NO_POSITION);
+        std::vector<uint32_t> queued_patterns;
+        std::vector<RaptorJourney> journeys;
+
+        for (size_t round = 1; !marked_stops.empty() && (max_bus_count == 0 || round <= max_bus_count); ++round) {
+            //Every pattern is scanned once from its first stop improved by the previous round
+            for (const uint32_t stop: marked_stops) {
+                for (size_t i = stop_pattern_offsets_[stop]; i < stop_pattern_offsets_[stop + 1]; ++i) {
+                    const auto [pattern, position] = stop_patterns_[i];
+                    if (first_positions[pattern] == NO_POSITION) {
+                        queued_patterns.push_back(pattern);
+                        first_positions[pattern] = position;
+                    } else {
+                        first_positions[pattern] = std::min(first_positions[pattern], position);
+                    }
+                }
+            }
+            marked_stops.clear();
+
+            const std::vector<double> &previous = arrivals.back();
+            std::vector<double> current = previous;
+            std::vector<Parent> current_parents = parents.back();
+
+            for (const uint32_t pattern_index: queued_patterns) {
+                const Pattern &pattern = patterns_[pattern_index];
+                uint32_t board_position = NO_POSITION;
+                for (uint32_t position = first_positions[pattern_index]; position < pattern.stops.size(); ++position) {
+                    const uint32_t stop = pattern.stops[position];
+                    if (board_position != NO_POSITION) {
+                        const size_t distance = pattern.distances[position] - pattern.distances[board_position];
+                        const double arrival = previous[pattern.stops[board_position]] + bus_wait_time
+                                               + distance / bus_velocity;
+                        //Arrivals later than the best one at the target can't be a part of a better journey
+                        if (arrival < current[stop] && arrival < current[target]) {
+                            current[stop] = arrival;
+                            current_parents[stop] = {pattern_index, board_position, position};
+                            if (!is_marked[stop]) {
+                                is_marked[stop] = true;
+                                marked_stops.push_back(stop);
+                            }
+                        }
+                    }
+                    //Boarding here is better for the rest of the pattern if the previous round reached the stop earlier
+                    if (previous[stop] < unreached
+                        && (board_position == NO_POSITION
+                            || previous[stop] < previous[pattern.stops[board_position]]
+                                                + (pattern.distances[position] - pattern.distances[board_position])
+                                                  / bus_velocity)) {
+                        board_position = position;
+                    }
+                }
+                first_positions[pattern_index] = NO_POSITION;
+            }
+            queued_patterns.clear();
+            for (const uint32_t stop: marked_stops) {
+                is_marked[stop] = false;
+            }
+
+            const bool is_improved = current[target] < previous[target];
+            arrivals.push_back(std::move(current));
+            parents.push_back(std::move(current_parents));
+            if (is_improved) {
+                journeys.push_back(ExtractJourney(arrivals, parents, target, round));
+            }
+        }
+        return journeys;
+    }
+
+    RaptorJourney RaptorRouter::ExtractJourney(const std::vector<std::vector<double>> &arrivals,
+                                               const std::vector<std::vector<Parent>> &parents, uint32_t to,
+                                               size_t round) const {
+        RaptorJourney journey;
+        journey.total_time = arrivals[round][to];
+        //A label of round k is either set in round k or copied from round k - 1 with its parent,
+        //so the parent of every round leads to the boarding stop reached one round earlier
+        for (uint32_t stop = to; round > 0 && parents[round][stop].pattern != NO_POSITION; --round) {
+            const Parent &parent = parents[round][stop];
+            const Pattern &pattern = patterns_[parent.pattern];
+            const uint32_t board_stop = pattern.stops[parent.board_position];
+            journey.legs.push_back({stops_[board_stop], stops_[stop], pattern.bus,
+                                    pattern.distances[parent.alight_position] - pattern.distances[parent.board_position],
+                                    static_cast<int>(parent.alight_position - parent.board_position)});
+            stop = board_stop;
+        }
+        std::reverse(journey.legs.begin(), journey.legs.end());
+        return journey;
+    }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include <cstdint>
+#include <vector>
+
+namespace transport_router {
+
+    //One ride of a journey, from boarding to alighting
+    struct RaptorLeg {
+        domain::StopPtr from = nullptr;
+        domain::StopPtr to = nullptr;
+        domain::BusPtr bus = nullptr;
+        size_t distance = 0;        //road distance in meters
+        int span_count = 0;
+    };
+
+    struct RaptorJourney {
+        double total_time = 0.0;    //seconds
+        std::vector<RaptorLeg> legs;
+    };
+
+    //Round-based search over the stop sequences of the buses without a priority queue. Buses have no timetable,
+    //every boarding waits bus_wait_time. Round k scans the buses boarded at the stops improved by round k - 1,
+    //so after it every stop has the fastest journey with at most k buses.
+    class RaptorRouter {
+    public:
+
+        explicit RaptorRouter(const transport_catalogue::TransportCatalogue &catalogue);
+
+        //Journeys faster than every journey with fewer buses, ordered by the number of buses.
+        //max_bus_count limits the rounds, 0 means no limit. Velocity is in m/s, wait time in seconds.
+        std::vector<RaptorJourney> FindJourneys(domain::StopPtr from, domain::StopPtr to, size_t max_bus_count,
+                                                double bus_velocity, double bus_wait_time) const;
+
+    private:
+
+        static constexpr uint32_t NO_POSITION = UINT32_MAX;
+
+        //Stops of a bus in the order of travel, the way back of a non-circular bus is a pattern of its own
+        struct Pattern {
+            domain::BusPtr bus = nullptr;
+            std::vector<uint32_t> stops;
+            std::vector<size_t> distances;      //road distance from the first stop
+        };
+
+        struct PatternStop {
+            uint32_t pattern;
+            uint32_t position;
+        };
+
+        struct Parent {
+            uint32_t pattern = NO_POSITION;
+            uint32_t board_position = NO_POSITION;
+            uint32_t alight_position = NO_POSITION;
+        };
+
+        void AddPattern(const transport_catalogue::TransportCatalogue &catalogue, domain::BusPtr bus, bool is_forward);
+        RaptorJourney ExtractJourney(const std::vector<std::vector<double>> &arrivals,
+                                     const std::vector<std::vector<Parent>> &parents, uint32_t to, size_t round) const;
+
+        //Stops by id
+        std::vector<domain::StopPtr> stops_;
+        std::vector<Pattern> patterns_;
+        //Patterns passing stop s are [stop_pattern_offsets_[s], stop_pattern_offsets_[s + 1]) of stop_patterns_
+        std::vector<size_t> stop_pattern_offsets_;
+        std::vector<PatternStop> stop_patterns_;
+    };
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//Answers whether any route leads from one vertex to another without searching. Vertices are
+//grouped into strongly connected components, components are numbered so that edges between them
+//go to lower ids, and every component keeps a bit set of the components it reaches.
+//Vertices without edges (stops no bus passes) get no component and reach nothing else.
+//An index without data knows nothing and reports every pair as reachable.
+class ReachabilityIndex {
+public:
+
+    static constexpr uint32_t NO_COMPONENT = std::numeric_limits<uint32_t>::max();
+
+    struct IndexData {
+        std::vector<uint32_t> vertex_components;
+        size_t component_count = 0;
+        //Row of component c is [c * GetRowSize(), (c + 1) * GetRowSize()), bit d is set if c reaches d
+        std::vector<uint64_t> reachable;
+    };
+
+    ReachabilityIndex() = default;
+
+    template <typename Weight>
+    explicit ReachabilityIndex(const DirectedWeightedGraph<Weight>& graph);
+
+    template <typename Weight>
+    ReachabilityIndex(const DirectedWeightedGraph<Weight>& graph, IndexData index_data);
+
+    bool IsReachable(VertexId from, VertexId to) const;
+
+    const IndexData& GetIndexData() const {
+        return index_data_;
+    }
+
+private:
+
+    size_t GetRowSize() const {
+        return (index_data_.component_count + 63) / 64;
+    }
+
+    template <typename Weight>
+    void FindComponents(const DirectedWeightedGraph<Weight>& graph);
+    template <typename Weight>
+    void FillReachable(const DirectedWeightedGraph<Weight>& graph);
+
+    IndexData index_data_;
+};
+
+template <typename Weight>
+ReachabilityIndex::ReachabilityIndex(const DirectedWeightedGraph<Weight>& graph) {
+    FindComponents(graph);
+    FillReachable(graph);
+}
+
+template <typename Weight>
+ReachabilityIndex::ReachabilityIndex(const DirectedWeightedGraph<Weight>& graph, IndexData index_data)
+    : index_data_(std::move(index_data))
+{
+    if (index_data_.vertex_components.size() != graph.GetVertexCount()
+        || index_data_.reachable.size() != index_data_.component_count * GetRowSize()
+        || std::any_of(index_data_.vertex_components.begin(), index_data_.vertex_components.end(),
+                       [this](uint32_t component) {
+                           return component != NO_COMPONENT && component >= index_data_.component_count;
+                       })) {
+        throw std::invalid_argument("Reachability index doesn't match the graph");
+    }
+}
+
+//Iterative Tarjan's algorithm, a component is numbered when it's completed, so the components
+//it has edges to are numbered before it
+template <typename Weight>
+void ReachabilityIndex::FindComponents(const DirectedWeightedGraph<Weight>& graph) {
+    constexpr uint32_t UNVISITED = std::numeric_limits<uint32_t>::max();
+    const size_t vertex_count = graph.GetVertexCount();
+    index_data_.vertex_components.assign(vertex_count, UNVISITED);
+    index_data_.component_count = 0;
+
+    std::vector<bool> has_edges(vertex_count, false);
+    for (const auto& edge : graph.GetEdges()) {
+        has_edges[edge.from] = true;
+        has_edges[edge.to] = true;
+    }
+
+    std::vector<uint32_t> visit_order(vertex_count, UNVISITED);
+    std::vector<uint32_t> low_link(vertex_count, 0);
+    std::vector<VertexId> component_stack;
+    //Vertex and the position of the next edge to follow
+    std::vector<std::pair<VertexId, size_t>> call_stack;
+    uint32_t visit_counter = 0;
+
+    for (VertexId root = 0; root < vertex_count; ++root) {
+        if (!has_edges[root]) {
+            index_data_.vertex_components[root] = NO_COMPONENT;
+            continue;
+        }
+        if (visit_order[root] != UNVISITED) {
+            continue;
+        }
+        call_stack.emplace_back(root, graph.GetEdgeOffsets()[root]);
+        visit_order[root] = low_link[root] = visit_counter++;
+        component_stack.push_back(root);
+
+        while (!call_stack.empty()) {
+            auto& [vertex, next_edge] = call_stack.back();
+            if (next_edge < graph.GetEdgeOffsets()[vertex + 1]) {
+                const VertexId to = graph.GetEdge(next_edge++).to;
+                if (visit_order[to] == UNVISITED) {
+                    visit_order[to] = low_link[to] = visit_counter++;
+                    component_stack.push_back(to);
+                    call_stack.emplace_back(to, graph.GetEdgeOffsets()[to]);
+                } else if (index_data_.vertex_components[to] == UNVISITED) {
+                    low_link[vertex] = std::min(low_link[vertex], visit_order[to]);
+                }
+                continue;
+            }
+
+            const VertexId finished = vertex;
+            call_stack.pop_back();
+            if (!call_stack.empty()) {
+                const VertexId parent = call_stack.back().first;
+                low_link[parent] = std::min(low_link[parent], low_link[finished]);
+            }
+            if (low_link[finished] == visit_order[finished]) {
+                const auto component = static_cast<uint32_t>(index_data_.component_count++);
+                VertexId member;
+                do {
+                    member = component_stack.back();
+                    component_stack.pop_back();
+                    index_data_.vertex_components[member] = component;
+                } while (member != finished);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ReachabilityIndex::FillReachable(const DirectedWeightedGraph<Weight>& graph) {
+    const size_t component_count = index_data_.component_count;
+    const size_t row_size = GetRowSize();
+    index_data_.reachable.assign(component_count * row_size, 0);
+
+    //Vertices grouped by component
+    std::vector<size_t> offsets(component_count + 1, 0);
+    for (const uint32_t component : index_data_.vertex_components) {
+        if (component != NO_COMPONENT) {
+            ++offsets[component + 1];
+        }
+    }
+    for (size_t component = 0; component < component_count; ++component) {
+        offsets[component + 1] += offsets[component];
+    }
+    std::vector<VertexId> members(graph.GetVertexCount());
+    {
+        std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+        for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+            if (index_data_.vertex_components[vertex] != NO_COMPONENT) {
+                members[positions[index_data_.vertex_components[vertex]]++] = vertex;
+            }
+        }
+    }
+
+    //Components reached by an edge have lower ids, their rows are complete
+    for (size_t component = 0; component < component_count; ++component) {
+        uint64_t* row = index_data_.reachable.data() + component * row_size;
+        row[component / 64] |= uint64_t{1} << (component % 64);
+        for (size_t i = offsets[component]; i < offsets[component + 1]; ++i) {
+            for (const EdgeId edge_id : graph.GetIncidentEdges(members[i])) {
+                const uint32_t target = index_data_.vertex_components[graph.GetEdge(edge_id).to];
+                if (target == component || (row[target / 64] >> (target % 64) & 1) != 0) {
+                    continue;
+                }
+                const uint64_t* target_row = index_data_.reachable.data() + target * row_size;
+                for (size_t word = 0; word < row_size; ++word) {
+                    row[word] |= target_row[word];
+                }
+            }
+        }
+    }
+}
+
+inline bool ReachabilityIndex::IsReachable(VertexId from, VertexId to) const {
+    if (from == to || index_data_.component_count == 0) {
+        return true;
+    }
+    const uint32_t from_component = index_data_.vertex_components.at(from);
+    const uint32_t to_component = index_data_.vertex_components.at(to);
+    if (from_component == NO_COMPONENT || to_component == NO_COMPONENT) {
+        return false;
+    }
+    return (index_data_.reachable[from_component * GetRowSize() + to_component / 64] >> (to_component % 64) & 1) != 0;
+}
+
+}  // namespace graph
@@ -110,7 +110,256 @@ json::Dict RequestHandler::GetRoute(const json::Node& request) {
 
     std::string from = request.AsDict().at("from"s).AsString();
     std::string to = request.AsDict().at("to"s).AsString();
-    const auto route_info = tr_.FindRoute(from, to);
+    if (!HasRouteSettings(request) && !HasTransferOptions(request)) {
+        return BuildRouteAnswer(id, tr_.FindRoute(from, to));
+    }
+
+    domain::RouteSettings settings = tr_.GetRouteSettings();
+    if (request.AsDict().count("bus_velocity"s)) {
+        settings.bus_velocity = request.AsDict().at("bus_velocity"s).AsDouble();
+    }
+    if (request.AsDict().count("bus_wait_time"s)) {
+        settings.bus_wait_time = request.AsDict().at("bus_wait_time"s).AsInt();
+    }
+    if (!HasTransferOptions(request)) {
+        return BuildRouteAnswer(id, tr_.FindRoute(from, to, settings));
+    }
+
+    size_t max_bus_count = 0;
+    if (request.AsDict().count("max_transfers"s)) {
+        const int max_transfers = request.AsDict().at("max_transfers"s).AsInt();
+        if (max_transfers < 0) {
+            throw std::invalid_argument("max_transfers should be non-negative");
+        }
+        max_bus_count = static_cast<size_t>(max_transfers) + 1;
+    }
+    auto routes = tr_.FindParetoRoutes(from, to, max_bus_count, settings);
+
+    const bool is_pareto = request.AsDict().count("pareto"s) && request.AsDict().at("pareto"s).AsBool();
+    if (!is_pareto || routes.empty()) {
+        //The last route of the Pareto set is the fastest one
+        return BuildRouteAnswer(id, routes.empty() ? std::nullopt : std::make_optional(std::move(routes.back())));
+    }
+
+    json::Array answers;
+    for (const auto& route : routes) {
+        json::Dict answer = BuildRouteAnswer(id, route);
+        answer.erase("request_id"s);
+        answers.push_back(std::move(answer));
+    }
+    return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("routes"s)
+            .Value(answers)
+            .EndDict()
+            .Build()
+            .AsDict();
+}
+
+bool RequestHandler::HasRouteSettings(const json::Node& request) {
+    using namespace std::string_literals;
+    return request.AsDict().count("bus_velocity"s) || request.AsDict().count("bus_wait_time"s);
+}
+
+bool RequestHandler::HasTransferOptions(const json::Node& request) {
+    using namespace std::string_literals;
+    return request.AsDict().count("max_transfers"s) || request.AsDict().count("pareto"s);
+}
+
+std::vector<json::Dict> RequestHandler::GetRoutes(const std::vector<const json::Node*>& requests) {
+    using namespace std::string_literals;
+
+    std::vector<json::Dict> result;
+    if (requests.empty()) {
+        return result;
+    }
+
+    std::string from = requests.front()->AsDict().at("from"s).AsString();
+    std::vector<std::string> to;
+    to.reserve(requests.size());
+    for (const auto* request : requests) {
+        to.push_back(request->AsDict().at("to"s).AsString());
+    }
+    const auto route_infos = tr_.FindRoutes(from, {to.begin(), to.end()});
+
+    result.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        result.push_back(BuildRouteAnswer(requests[i]->AsDict().at("id"s).AsInt(), route_infos[i]));
+    }
+    return result;
+}
+
+json::Dict RequestHandler::GetIsochrone(const json::Node& request) {
+    using namespace std::string_literals;
+
+    int id = request.AsDict().at("id"s).AsInt();
+    std::string from = request.AsDict().at("from"s).AsString();
+    double max_time = request.AsDict().at("max_time"s).AsDouble();
+
+    if (tc_.FindStop(from) == nullptr) {
+        return json::Builder{}
+                .StartDict()
+                .Key("request_id"s)
+                .Value(id)
+                .Key("error_message"s)
+                .Value("not found"s)
+                .EndDict()
+                .Build()
+                .AsDict();
+    }
+
+    json::Array stops;
+    for (const auto& [stop, time] : tr_.FindReachableStops(from, max_time * 60)) {
+        stops.push_back(json::Builder{}
+                                .StartDict()
+                                .Key("stop_name"s)
+                                .Value(stop->name)
+                                .Key("time"s)
+                                .Value(time / 60)
+                                .EndDict()
+                                .Build()
+                                .AsDict());
+    }
+    return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("stops"s)
+            .Value(stops)
+            .EndDict()
+            .Build()
+            .AsDict();
+}
+
+json::Dict RequestHandler::GetNearestStops(const json::Node& request) {
+    using namespace std::string_literals;
+
+    const auto& request_dict = request.AsDict();
+    const int count = request_dict.at("count"s).AsInt();
+    const geo::Coordinates position{request_dict.at("latitude"s).AsDouble(), request_dict.at("longitude"s).AsDouble()};
+    return BuildStopsAnswer(request_dict.at("id"s).AsInt(),
+                            tc_.FindNearestStops(position, count > 0 ? static_cast<size_t>(count) : 0));
+}
+
+json::Dict RequestHandler::GetStopsInRadius(const json::Node& request) {
+    using namespace std::string_literals;
+
+    const auto& request_dict = request.AsDict();
+    const geo::Coordinates position{request_dict.at("latitude"s).AsDouble(), request_dict.at("longitude"s).AsDouble()};
+    return BuildStopsAnswer(request_dict.at("id"s).AsInt(),
+                            tc_.FindStopsInRadius(position, request_dict.at("radius"s).AsDouble()));
+}
+
+json::Dict RequestHandler::BuildStopsAnswer(int id, const std::vector<std::pair<domain::StopPtr, double>>& stops) {
+    using namespace std::string_literals;
+
+    json::Array stops_array;
+    stops_array.reserve(stops.size());
+    for (const auto& [stop, distance] : stops) {
+        stops_array.push_back(json::Builder{}
+                                      .StartDict()
+                                      .Key("stop_name"s)
+                                      .Value(stop->name)
+                                      .Key("distance"s)
+                                      .Value(distance)
+                                      .EndDict()
+                                      .Build()
+                                      .AsDict());
+    }
+    return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("stops"s)
+            .Value(stops_array)
+            .EndDict()
+            .Build()
+            .AsDict();
+}
+
+RequestHandler::TimeMatrix RequestHandler::GetMatrix(const json::Node& request) {
+    using namespace std::string_literals;
+
+    const auto read_names = [&request](const std::string& key) {
+        std::vector<std::string> names;
+        const json::Array name_nodes = request.AsDict().at(key).AsArray();
+        for (const auto& name : name_nodes) {
+            names.push_back(name.AsString());
+        }
+        return names;
+    };
+    const std::vector<std::string> from = read_names("from"s);
+    const std::vector<std::string> to = read_names("to"s);
+
+    TimeMatrix matrix;
+    matrix.request_id = request.AsDict().at("id"s).AsInt();
+    matrix.row_count = from.size();
+    matrix.column_count = to.size();
+    matrix.times = tr_.FindTimeMatrix({from.begin(), from.end()}, {to.begin(), to.end()});
+    for (auto& time : matrix.times) {
+        if (time) {
+            *time /= 60;
+        }
+    }
+    return matrix;
+}
+
+void RequestHandler::PrintMatrix(const TimeMatrix& matrix, std::ostream& out) {
+    //Same layout as json::Print of {"request_id": ..., "times": [[...], ...]}
+    out << "{\"request_id\": " << matrix.request_id << ", \"times\": [";
+    for (size_t row = 0; row < matrix.row_count; ++row) {
+        out << (row > 0 ? ", [" : "[");
+        for (size_t column = 0; column < matrix.column_count; ++column) {
+            if (column > 0) {
+                out << ", ";
+            }
+            const auto& time = matrix.times[row * matrix.column_count + column];
+            if (time) {
+                out << *time;
+            } else {
+                out << "null";
+            }
+        }
+        out << "]";
+    }
+    out << "]}";
+}
+
+json::Dict RequestHandler::GetRouteTime(const json::Node& request) {
+    using namespace std::string_literals;
+
+    int id = request.AsDict().at("id"s).AsInt();
+    std::string from = request.AsDict().at("from"s).AsString();
+    std::string to = request.AsDict().at("to"s).AsString();
+
+    const auto duration = tr_.FindRouteDuration(from, to);
+    if (!duration.has_value()) {
+        return json::Builder{}
+                .StartDict()
+                .Key("request_id"s)
+                .Value(id)
+                .Key("error_message"s)
+                .Value("not found"s)
+                .EndDict()
+                .Build()
+                .AsDict();
+    }
+    return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("total_time"s)
+            .Value((duration->waiting_time + duration->travel_time) / 60)
+            .EndDict()
+            .Build()
+            .AsDict();
+}
+
+json::Dict RequestHandler::BuildRouteAnswer(int id,
+                                            const std::optional<std::vector<transport_router::TravelProps>>& route_info) {
+    using namespace std::string_literals;
 
     if (!route_info.has_value()) {
         return json::Builder{}
@@ -125,33 +374,33 @@ json::Dict RequestHandler::GetRoute(const json::Node& request) {
     }
     json::Array items;
     double total_time = 0.0;
-    for (auto* route_item : *route_info) {
+    for (const auto& route_item : *route_info) {
         items.push_back(json::Builder{}
                                 .StartDict()
                                 .Key("type"s)
                                 .Value("Wait"s)
                                 .Key("stop_name"s)
-                                .Value(route_item->from->name)
+                                .Value(route_item.from->name)
                                 .Key("time"s)
-                                .Value(route_item->travel_duration.waiting_time / 60)
+                                .Value(route_item.travel_duration.waiting_time / 60)
                                 .EndDict()
                                 .Build()
                                 .AsDict());
-        total_time += route_item->travel_duration.waiting_time / 60;
+        total_time += route_item.travel_duration.waiting_time / 60;
         items.push_back(json::Builder{}
                                 .StartDict()
                                 .Key("type"s)
                                 .Value("Bus"s)
                                 .Key("bus"s)
-                                .Value(route_item->route->bus_name)
+                                .Value(route_item.route->bus_name)
                                 .Key("span_count"s)
-                                .Value(route_item->travel_duration.stops_number)
+                                .Value(route_item.travel_duration.stops_number)
                                 .Key("time"s)
-                                .Value(route_item->travel_duration.travel_time / 60)
+                                .Value(route_item.travel_duration.travel_time / 60)
                                 .EndDict()
                                 .Build()
                                 .AsDict());
-        total_time += route_item->travel_duration.travel_time / 60;
+        total_time += route_item.travel_duration.travel_time / 60;
     }
     return json::Builder{}
             .StartDict()
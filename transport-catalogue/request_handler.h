@@ -6,10 +6,20 @@
 #include "json.h"
 #include "json_builder.h"
 #include <optional>
+#include <ostream>
+#include <vector>
 
 class RequestHandler {
 public:
 
+    //Matrix answer, kept apart from json::Node and printed straight to the output
+    struct TimeMatrix {
+        int request_id = 0;
+        size_t row_count = 0;
+        size_t column_count = 0;
+        std::vector<std::optional<double>> times;       //minutes, row-major
+    };
+
     RequestHandler(const transport_catalogue::TransportCatalogue &tc, const renderer::MapRenderer &renderer,
                    const transport_router::TransportRouter& router);
 
@@ -18,10 +28,31 @@ public:
     json::Dict GetBus(const json::Node& request);
     json::Dict GetStop(const json::Node& request);
     json::Dict GetMap(const json::Node& request);
+    //Route request may override bus_velocity and bus_wait_time of routing_settings.
+    //max_transfers limits the buses of the route, "pareto": true answers with "routes", the fastest route
+    //for every number of buses that is faster than the routes with fewer buses
     json::Dict GetRoute(const json::Node& request);
+    static bool HasRouteSettings(const json::Node& request);
+    static bool HasTransferOptions(const json::Node& request);
+    //Route requests that share the same "from" stop
+    std::vector<json::Dict> GetRoutes(const std::vector<const json::Node*>& requests);
+    //Stops reachable within max_time minutes
+    json::Dict GetIsochrone(const json::Node& request);
+    //Route times from every stop of "from" to every stop of "to"
+    TimeMatrix GetMatrix(const json::Node& request);
+    static void PrintMatrix(const TimeMatrix& matrix, std::ostream& out);
+    //total_time of the route without its items
+    json::Dict GetRouteTime(const json::Node& request);
+    //Up to "count" stops closest to "latitude" and "longitude", distances are in meters
+    json::Dict GetNearestStops(const json::Node& request);
+    //Stops within "radius" meters of "latitude" and "longitude"
+    json::Dict GetStopsInRadius(const json::Node& request);
 
 private:
 
+    static json::Dict BuildStopsAnswer(int id, const std::vector<std::pair<domain::StopPtr, double>>& stops);
+    static json::Dict BuildRouteAnswer(int id, const std::optional<std::vector<transport_router::TravelProps>>& route_info);
+
     const transport_catalogue::TransportCatalogue& tc_;
     const renderer::MapRenderer& renderer_;
     const transport_router::TransportRouter& tr_;
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "graph.h"
+#include "parallel.h"
+#include "search_scratch.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
@@ -15,35 +18,96 @@
 namespace graph {
 
 template <typename Weight>
-class Router {
-private:
-
-    using Graph = DirectedWeightedGraph<Weight>;
-
+class RouterBase {
 public:
 
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
+    virtual ~RouterBase() = default;
+
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+    //One route per target, engines with a single-source search override it to search once
+    virtual std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(BuildRoute(from, to));
+        }
+        return routes;
+    }
+
+    //Weight of the route only, engines that know it without the edges override it
+    virtual std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const {
+        const auto route = BuildRoute(from, to);
+        if (!route) {
+            return std::nullopt;
+        }
+        return route->weight;
+    }
+};
+
+template <typename Weight>
+class Router final : public RouterBase<Weight> {
+private:
+
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+
+    using typename RouterBase<Weight>::RouteInfo;
+
     struct RouteInternalData {
         Weight weight;
         std::optional<EdgeId> prev_edge;
     };
     using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
 
+    //Selects the constructor that fills the table with one Dijkstra search per source,
+    //O(V E log V) instead of O(V^3) on sparse graphs
+    struct PerSourceSearch {};
+
+    explicit Router(const Graph& graph, size_t thread_count = parallel::GetThreadCount());
+    Router(const Graph& graph, PerSourceSearch, size_t thread_count = parallel::GetThreadCount());
+    Router(const Graph& graph, RoutesInternalData routes_internal_data);
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
-    const RoutesInternalData GetRoutesInternalData() const {
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    const RoutesInternalData& GetRoutesInternalData() const {
         return routes_internal_data_;
     }
 
 private:
 
+    void CheckEdgeWeights(const Graph& graph) const {
+        for (const auto& edge : graph.GetEdges()) {
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    //The row of the source is the search tree, prev_edge of every vertex is the last edge of its route
+    void FillRowBySearch(SearchScratch<Weight>& scratch, VertexId from) {
+        const size_t vertex_count = graph_.GetVertexCount();
+        auto& row = routes_internal_data_[from];
+        row.assign(vertex_count, std::nullopt);
+        scratch.Prepare(vertex_count);
+        scratch.Relax(from, ZERO_WEIGHT, std::nullopt);
+        while (const auto vertex = scratch.PopNext()) {
+            const Weight weight = scratch.GetWeight(*vertex);
+            row[*vertex] = RouteInternalData{weight, scratch.GetPrevEdge(*vertex)};
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(*vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                scratch.Relax(edge.to, weight + edge.weight, edge_id);
+            }
+        }
+    }
+
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
@@ -71,18 +135,52 @@ private:
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    //Rows [row_begin, row_end) are walked in column tiles so the tile of the pivot row stays in cache
+    void RelaxRowsThroughVertex(size_t vertex_count, VertexId vertex_through, VertexId row_begin, VertexId row_end) {
+        const auto& routes_through = routes_internal_data_[vertex_through];
+        for (VertexId column_begin = 0; column_begin < vertex_count; column_begin += COLUMN_BLOCK_SIZE) {
+            const VertexId column_end = std::min(column_begin + COLUMN_BLOCK_SIZE, vertex_count);
+            for (VertexId vertex_from = row_begin; vertex_from < row_end; ++vertex_from) {
+                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
+                    for (VertexId vertex_to = column_begin; vertex_to < column_end; ++vertex_to) {
+                        if (const auto& route_to = routes_through[vertex_to]) {
+                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+                        }
                     }
                 }
             }
         }
     }
 
+    //Within one pivot iteration the pivot row and column never change (weights are non-negative),
+    //so row blocks are independent and the result is the same as the sequential relaxation.
+    void RelaxRoutesInternalData(size_t vertex_count, size_t thread_count) {
+        const size_t row_block_count = (vertex_count + ROW_BLOCK_SIZE - 1) / ROW_BLOCK_SIZE;
+        if (vertex_count < PARALLEL_MIN_VERTEX_COUNT) {
+            thread_count = 1;
+        }
+        thread_count = std::max<size_t>(1, std::min(thread_count, row_block_count));
+
+        std::atomic<size_t> next_row_block{0};
+        parallel::Barrier barrier(thread_count, [&next_row_block]() {
+            next_row_block = 0;
+        });
+
+        parallel::RunOnThreads(thread_count, [&](size_t) {
+            for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+                for (size_t row_block = next_row_block++; row_block < row_block_count; row_block = next_row_block++) {
+                    const VertexId row_begin = row_block * ROW_BLOCK_SIZE;
+                    RelaxRowsThroughVertex(vertex_count, vertex_through, row_begin,
+                                           std::min(row_begin + ROW_BLOCK_SIZE, vertex_count));
+                }
+                barrier.ArriveAndWait();
+            }
+        });
+    }
+
+    static constexpr size_t ROW_BLOCK_SIZE = 16;
+    static constexpr size_t COLUMN_BLOCK_SIZE = 256;
+    static constexpr size_t PARALLEL_MIN_VERTEX_COUNT = 256;
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
@@ -90,16 +188,54 @@ private:
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, size_t thread_count)
     : graph_(graph)
     , routes_internal_data_(graph.GetVertexCount(),
                             std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
 {
     InitializeRoutesInternalData(graph);
+    RelaxRoutesInternalData(graph.GetVertexCount(), thread_count);
+}
 
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, PerSourceSearch, size_t thread_count)
+    : graph_(graph)
+    , routes_internal_data_(graph.GetVertexCount())
+{
+    CheckEdgeWeights(graph);
+    //Every search writes only the row of its source, rows are taken from a work-stealing queue
+    //since the search trees differ in size
+    std::vector<SearchScratch<Weight>> scratches(std::max<size_t>(1, thread_count));
+    parallel::RunStealingTasks(graph.GetVertexCount(), thread_count, [this, &scratches](size_t thread_index,
+                                                                                         size_t from) {
+        FillRowBySearch(scratches[thread_index], static_cast<VertexId>(from));
+    });
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+    : graph_(graph)
+    , routes_internal_data_(std::move(routes_internal_data))
+{
     const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    if (routes_internal_data_.size() != vertex_count
+        || std::any_of(routes_internal_data_.begin(), routes_internal_data_.end(),
+                       [vertex_count](const auto& row) { return row.size() != vertex_count; })) {
+        throw std::invalid_argument("Routes internal data doesn't match the graph");
+    }
+    //BuildRoute follows prev_edge back to the source, every edge has to end at its cell's vertex
+    //and start at a vertex the source reaches
+    for (const auto& row : routes_internal_data_) {
+        for (VertexId to = 0; to < vertex_count; ++to) {
+            if (!row[to] || !row[to]->prev_edge) {
+                continue;
+            }
+            const EdgeId edge_id = *row[to]->prev_edge;
+            if (edge_id >= graph.GetEdgeCount() || graph.GetEdge(edge_id).to != to
+                || !row[graph.GetEdge(edge_id).from]) {
+                throw std::invalid_argument("Routes internal data doesn't match the graph");
+            }
+        }
     }
 }
 
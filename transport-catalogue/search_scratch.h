@@ -0,0 +1,112 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+//State of a Dijkstra search that is reused between searches. Marks are compared with
+//the current generation, so nothing has to be cleared before the next search.
+template <typename Weight>
+class SearchScratch {
+public:
+
+    void Prepare(size_t vertex_count) {
+        if (visit_marks_.size() < vertex_count) {
+            weights_.resize(vertex_count);
+            prev_edges_.resize(vertex_count);
+            visit_marks_.resize(vertex_count, 0);
+            settle_marks_.resize(vertex_count, 0);
+        }
+        queue_.clear();
+        if (++generation_ == 0) {
+            std::fill(visit_marks_.begin(), visit_marks_.end(), 0);
+            std::fill(settle_marks_.begin(), settle_marks_.end(), 0);
+            generation_ = 1;
+        }
+    }
+
+    bool IsReached(VertexId vertex) const {
+        return visit_marks_[vertex] == generation_;
+    }
+
+    bool IsSettled(VertexId vertex) const {
+        return settle_marks_[vertex] == generation_;
+    }
+
+    const Weight& GetWeight(VertexId vertex) const {
+        return weights_[vertex];
+    }
+
+    std::optional<EdgeId> GetPrevEdge(VertexId vertex) const {
+        return prev_edges_[vertex];
+    }
+
+    //Queues the vertex if the weight improves on what is known, key orders the queue
+    bool Relax(VertexId vertex, const Weight& weight, std::optional<EdgeId> prev_edge, const Weight& key) {
+        if (IsSettled(vertex) || (IsReached(vertex) && !(weight < weights_[vertex]))) {
+            return false;
+        }
+        visit_marks_[vertex] = generation_;
+        weights_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+        queue_.push_back({key, vertex});
+        std::push_heap(queue_.begin(), queue_.end(), QueueLess);
+        return true;
+    }
+
+    bool Relax(VertexId vertex, const Weight& weight, std::optional<EdgeId> prev_edge) {
+        return Relax(vertex, weight, prev_edge, weight);
+    }
+
+    //Key of the next vertex to settle
+    std::optional<Weight> PeekKey() {
+        DropSettled();
+        if (queue_.empty()) {
+            return std::nullopt;
+        }
+        return queue_.front().first;
+    }
+
+    //Settles the next vertex
+    std::optional<VertexId> PopNext() {
+        DropSettled();
+        if (queue_.empty()) {
+            return std::nullopt;
+        }
+        std::pop_heap(queue_.begin(), queue_.end(), QueueLess);
+        const VertexId vertex = queue_.back().second;
+        queue_.pop_back();
+        settle_marks_[vertex] = generation_;
+        return vertex;
+    }
+
+private:
+
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    static bool QueueLess(const QueueItem& lhs, const QueueItem& rhs) {
+        return rhs.first < lhs.first;
+    }
+
+    void DropSettled() {
+        while (!queue_.empty() && IsSettled(queue_.front().second)) {
+            std::pop_heap(queue_.begin(), queue_.end(), QueueLess);
+            queue_.pop_back();
+        }
+    }
+
+    std::vector<Weight> weights_;
+    std::vector<std::optional<EdgeId>> prev_edges_;
+    std::vector<uint32_t> visit_marks_;
+    std::vector<uint32_t> settle_marks_;
+    std::vector<QueueItem> queue_;
+    uint32_t generation_ = 0;
+};
+
+}  // namespace graph
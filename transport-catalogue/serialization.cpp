@@ -29,6 +29,14 @@ namespace serialization {
             bus_base.add_stop_in_bus_route(stop->name);
         }
         bus_base.set_is_circle(bus.is_circle);
+        if (bus.id < tc_.GetBusStats().size()) {
+            const auto &bus_stats = tc_.GetBusStats()[bus.id];
+            auto &stats_base = *bus_base.mutable_stats();
+            stats_base.set_stop_count(bus_stats.stop_count);
+            stats_base.set_unique_stop_count(bus_stats.unique_stop_count);
+            stats_base.set_route_length(bus_stats.route_length);
+            stats_base.set_curvature(bus_stats.curvature);
+        }
 
         return bus_base;
     }
@@ -44,23 +52,36 @@ namespace serialization {
         return stop_distance;
     }
 
+    //Stops are saved in the order of their ids, loading them in the same order restores the ids
     void Serialization::SaveStops() {
         for (const auto stop: tc_.GetStopBase()) {
-            *data_base_.mutable_transport_cat_core()->add_stops() = std::move(SaveStop(stop));
+            *data_base_.mutable_transport_cat_core()->add_stops() = std::move(SaveStop(*stop));
         }
     }
 
     void Serialization::SaveBuses() {
-        for (const auto bus: tc_.GetBusBase()) {
+        for (const auto &bus: tc_.GetBusBase()) {
             *data_base_.mutable_transport_cat_core()->add_buses() = std::move(SaveBus(bus));
         }
     }
 
     void Serialization::SaveDistance() {
-        for (const auto [stop_pair, distance]: tc_.GetDistanceBase()) {
-            *data_base_.mutable_transport_cat_core()->add_distance_between_stop() = std::move(
-                    SaveDistance(stop_pair.first, stop_pair.second, distance));
-        }
+        tc_.ForEachGivenDistance([this](domain::StopPtr from, domain::StopPtr to, uint32_t distance) {
+            *data_base_.mutable_transport_cat_core()->add_distance_between_stop() = SaveDistance(from, to, distance);
+        });
+    }
+
+    void Serialization::SaveStopIndex() {
+        const auto &index_data = tc_.GetStopIndex().GetIndexData();
+        auto &index_proto = *data_base_.mutable_transport_cat_core()->mutable_stop_index();
+        index_proto.set_min_latitude(index_data.min_latitude);
+        index_proto.set_min_longitude(index_data.min_longitude);
+        index_proto.set_cell_height(index_data.cell_height);
+        index_proto.set_cell_width(index_data.cell_width);
+        index_proto.set_row_count(index_data.row_count);
+        index_proto.set_column_count(index_data.column_count);
+        index_proto.mutable_cell_offsets()->Add(index_data.cell_offsets.begin(), index_data.cell_offsets.end());
+        index_proto.mutable_cell_stops()->Add(index_data.cell_points.begin(), index_data.cell_points.end());
     }
 
     void Serialization::SaveDataBase() {
@@ -71,6 +92,7 @@ namespace serialization {
         SaveStops();
         SaveBuses();
         SaveDistance();
+        SaveStopIndex();
         SaveRenderSettings();
         SaveRouteSetting();
         SaveGraphs();
@@ -88,6 +110,8 @@ namespace serialization {
         LoadStops();
         LoadBuses();
         LoadDistance();
+        LoadBusStats();
+        LoadStopIndex();
         LoadRenderSettings();
         LoadRouteSetting();
         LoadGraphs();
@@ -109,6 +133,42 @@ namespace serialization {
         for (int i = 0; i < data_base_.transport_cat_core().distance_between_stop_size(); ++i) {
             LoadDistance(data_base_.transport_cat_core().distance_between_stop(i));
         }
+        tc_.FreezeDistances();
+    }
+
+    //A base saved without the statistics gets them computed
+    void Serialization::LoadBusStats() {
+        const auto &buses = data_base_.transport_cat_core().buses();
+        if (!std::all_of(buses.begin(), buses.end(), [](const tc_serialize::Bus &bus) { return bus.has_stats(); })) {
+            tc_.ComputeBusStats();
+            return;
+        }
+        std::vector<transport_catalogue::BusStats> bus_stats;
+        bus_stats.reserve(buses.size());
+        for (const auto &bus: buses) {
+            bus_stats.push_back({bus.stats().stop_count(), bus.stats().unique_stop_count(),
+                                 bus.stats().route_length(), bus.stats().curvature()});
+        }
+        tc_.SetBusStats(std::move(bus_stats));
+    }
+
+    //A base saved without the index gets it built
+    void Serialization::LoadStopIndex() {
+        if (!data_base_.transport_cat_core().has_stop_index()) {
+            tc_.BuildStopIndex();
+            return;
+        }
+        const auto &index_proto = data_base_.transport_cat_core().stop_index();
+        geo::GridIndex::IndexData index_data;
+        index_data.min_latitude = index_proto.min_latitude();
+        index_data.min_longitude = index_proto.min_longitude();
+        index_data.cell_height = index_proto.cell_height();
+        index_data.cell_width = index_proto.cell_width();
+        index_data.row_count = index_proto.row_count();
+        index_data.column_count = index_proto.column_count();
+        index_data.cell_offsets.assign(index_proto.cell_offsets().begin(), index_proto.cell_offsets().end());
+        index_data.cell_points.assign(index_proto.cell_stops().begin(), index_proto.cell_stops().end());
+        tc_.SetStopIndex(std::move(index_data));
     }
 
     void Serialization::LoadStop(const tc_serialize::Stop &stop) {
@@ -132,7 +192,7 @@ namespace serialization {
 
     void Serialization::LoadDistance(const tc_serialize::DistanceBetweenStop &distance) {
         tc_.SetDistanceStops(tc_.FindStop(distance.stop_from_name()), tc_.FindStop(distance.stop_to_name()),
-                             distance.distance());
+                             static_cast<uint32_t>(std::llround(distance.distance())));
     }
 
 //Map renderer
@@ -279,30 +339,26 @@ namespace serialization {
 
         data_base_.mutable_router_core()->mutable_route_setting()->set_bus_velocity(settings.bus_velocity);
         data_base_.mutable_router_core()->mutable_route_setting()->set_bus_wait_time(settings.bus_wait_time);
+        data_base_.mutable_router_core()->mutable_route_setting()->set_router_engine(
+                static_cast<router_proto::RouterEngine>(settings.router_engine));
+        data_base_.mutable_router_core()->mutable_route_setting()->set_graph_model(
+                static_cast<router_proto::GraphModel>(settings.graph_model));
+        data_base_.mutable_router_core()->mutable_route_setting()->set_route_cache_size(settings.route_cache_size);
     }
 
     void Serialization::SaveGraphs() {
-        SaveGraphVertex();
         SaveGraphEdge();
         SaveGraph();
-    }
-
-    void Serialization::SaveGraphVertex() {
-        auto vertex = tr_.GetGraphVertex();
-        for (const auto [stop, vertex_id]: vertex) {
-            router_proto::Graph_Vertex_ID vertex_id_point;
-
-            *vertex_id_point.mutable_stop_name() = stop->name;
-            vertex_id_point.set_vertex_id(vertex_id);
-
-            *data_base_.mutable_router_core()->mutable_graphs()->add_graph_vertex() = vertex_id_point;
-        }
+        SaveRoutesInternalData();
+        SaveCompactRoutesInternalData();
+        SaveContractionHierarchy();
+        SaveOverlayPartition();
+        SaveHubLabels();
+        SaveReachabilityIndex();
     }
 
     void Serialization::SaveGraphEdge() {
-        auto edge = tr_.GetGraphEdges();
-
-        for (const auto travel_prop: edge) {
+        for (const auto &travel_prop: tr_.GetGraphEdges()) {
             router_proto::Travel_Duration travel_duration_proto;
             travel_duration_proto.set_stop_number(travel_prop.travel_duration.stops_number);
             travel_duration_proto.set_waiting_time(travel_prop.travel_duration.waiting_time);
@@ -313,6 +369,9 @@ namespace serialization {
             *travel_props_proto.mutable_stop_name_to() = travel_prop.to->name;
             *travel_props_proto.mutable_bus_name() = travel_prop.route->bus_name;
             *travel_props_proto.mutable_travel_duration() = travel_duration_proto;
+            travel_props_proto.set_kind(static_cast<router_proto::Travel_Kind>(travel_prop.kind));
+            travel_props_proto.set_distance(travel_prop.distance);
+            travel_props_proto.set_span_count(travel_prop.span_count);
 
             *data_base_.mutable_router_core()->mutable_graphs()->add_graph_edges() = travel_props_proto;
         }
@@ -320,56 +379,152 @@ namespace serialization {
     }
 
     void Serialization::SaveGraph() {
-// Add Edges
-        auto edges = tr_.GetGraph().GetEdges();
-        for (const auto edge: edges) {
-            router_proto::Travel_Duration weight_graph_proto;
-            weight_graph_proto.set_stop_number(edge.weight.stops_number);
-            weight_graph_proto.set_travel_time(edge.weight.travel_time);
-            weight_graph_proto.set_waiting_time(edge.weight.waiting_time);
-
-            router_proto::Edge edge_proto;
-            edge_proto.set_edge_from(edge.from);
-            edge_proto.set_edge_to(edge.to);
-            *edge_proto.mutable_weight_graph() = weight_graph_proto;
-
-            *data_base_.mutable_router_core()->mutable_graphs()->mutable_graph()->add_edges_in_graph() = edge_proto;
-        }
-// Add IncidenceLists
-        auto incidence_lists = tr_.GetGraph().GetIncidenceLists();
-        for (int i = 0; i < incidence_lists.size(); ++i) {
-            router_proto::Incidence_List incidence_list_proto;
-            for (int y = 0; y < incidence_lists[i].size(); ++y) {
-                incidence_list_proto.add_incidence_list(incidence_lists[i][y]);
+        const auto &graph = tr_.GetGraph();
+        auto &graph_proto = *data_base_.mutable_router_core()->mutable_graphs()->mutable_graph();
+
+        graph_proto.mutable_edge_offsets()->Add(graph.GetEdgeOffsets().begin(), graph.GetEdgeOffsets().end());
+        graph_proto.mutable_edge_to()->Reserve(graph.GetEdgeCount());
+        graph_proto.mutable_stop_number()->Reserve(graph.GetEdgeCount());
+        graph_proto.mutable_waiting_time()->Reserve(graph.GetEdgeCount());
+        graph_proto.mutable_travel_time()->Reserve(graph.GetEdgeCount());
+        for (const auto &edge: graph.GetEdges()) {
+            const auto weight = transport_router::ToTravelDuration(edge.weight);
+            graph_proto.add_edge_to(edge.to);
+            graph_proto.add_stop_number(weight.stops_number);
+            graph_proto.add_waiting_time(weight.waiting_time);
+            graph_proto.add_travel_time(weight.travel_time);
+        }
+    }
+
+    void Serialization::SaveRoutesInternalData() {
+        const auto *routes_internal_data = tr_.GetRoutesInternalData();
+        if (routes_internal_data == nullptr) {
+            return;
+        }
+
+        auto &data_proto = *data_base_.mutable_router_core()->mutable_routes_internal_data();
+        const size_t vertex_count = routes_internal_data->size();
+        data_proto.set_vertex_count(vertex_count);
+        data_proto.mutable_prev_edge()->Reserve(vertex_count * vertex_count);
+
+        for (const auto &row: *routes_internal_data) {
+            for (const auto &cell: row) {
+                if (!cell.has_value()) {
+                    data_proto.add_prev_edge(0);
+                    continue;
+                }
+                const auto weight = transport_router::ToTravelDuration(cell->weight);
+                data_proto.add_prev_edge(cell->prev_edge.has_value() ? *cell->prev_edge + 2 : 1);
+                data_proto.add_stop_number(weight.stops_number);
+                data_proto.add_waiting_time(weight.waiting_time);
+                data_proto.add_travel_time(weight.travel_time);
+            }
+        }
+    }
+
+    void Serialization::SaveCompactRoutesInternalData() {
+        using CompactRouter = graph::CompactRouter<transport_router::RouteWeight>;
+
+        const auto *routes_internal_data = tr_.GetCompactRoutesInternalData();
+        if (routes_internal_data == nullptr) {
+            return;
+        }
+
+        auto &data_proto = *data_base_.mutable_router_core()->mutable_compact_routes_internal_data();
+        data_proto.set_vertex_count(tr_.GetGraph().GetVertexCount());
+        data_proto.mutable_prev_edge()->Reserve(routes_internal_data->size());
+        data_proto.mutable_weight()->Reserve(routes_internal_data->size());
+
+        for (const auto &cell: *routes_internal_data) {
+            data_proto.add_prev_edge(cell.prev_edge == CompactRouter::NO_EDGE ? 0 : cell.prev_edge + 1);
+            data_proto.add_weight(cell.weight == CompactRouter::UNREACHABLE ? 0 : cell.weight + 1);
+        }
+    }
+
+    void Serialization::SaveContractionHierarchy() {
+        const auto *hierarchy_data = tr_.GetHierarchyData();
+        if (hierarchy_data == nullptr) {
+            return;
+        }
+
+        auto &hierarchy_proto = *data_base_.mutable_router_core()->mutable_contraction_hierarchy();
+        for (const size_t rank: hierarchy_data->vertex_ranks) {
+            hierarchy_proto.add_vertex_rank(rank);
+        }
+        for (const auto &shortcut: hierarchy_data->shortcuts) {
+            hierarchy_proto.add_shortcut_first_arc(shortcut.first_arc);
+            hierarchy_proto.add_shortcut_second_arc(shortcut.second_arc);
+        }
+    }
+
+    void Serialization::SaveOverlayPartition() {
+        const auto *overlay_partition = tr_.GetOverlayPartition();
+        if (overlay_partition == nullptr) {
+            return;
+        }
+
+        auto &partition_proto = *data_base_.mutable_router_core()->mutable_overlay_partition();
+        for (const auto &cell_ids: *overlay_partition) {
+            auto &level_proto = *partition_proto.add_level();
+            level_proto.mutable_cell_id()->Reserve(cell_ids.size());
+            for (const uint32_t cell_id: cell_ids) {
+                level_proto.add_cell_id(cell_id);
             }
-            *data_base_.mutable_router_core()->mutable_graphs()->mutable_graph()->add_incidence_lists() = incidence_list_proto;
         }
     }
 
+    void Serialization::SaveHubLabels() {
+        using HubLabels = graph::HubLabels<transport_router::RouteWeight>;
+
+        const auto *hub_label_data = tr_.GetHubLabelData();
+        if (hub_label_data == nullptr) {
+            return;
+        }
+
+        const auto save_labels = [](const HubLabels::Labels &labels, router_proto::Hub_Label_Set &labels_proto) {
+            for (const size_t offset: labels.offsets) {
+                labels_proto.add_offset(offset);
+            }
+            for (const auto &entry: labels.entries) {
+                const auto weight = transport_router::ToTravelDuration(entry.weight);
+                labels_proto.add_hub(entry.hub);
+                labels_proto.add_edge(entry.edge == HubLabels::NO_EDGE ? 0 : entry.edge + 1);
+                labels_proto.add_stop_number(weight.stops_number);
+                labels_proto.add_waiting_time(weight.waiting_time);
+                labels_proto.add_travel_time(weight.travel_time);
+            }
+        };
+        auto &hub_labels_proto = *data_base_.mutable_router_core()->mutable_hub_labels();
+        save_labels(hub_label_data->out_labels, *hub_labels_proto.mutable_out_labels());
+        save_labels(hub_label_data->in_labels, *hub_labels_proto.mutable_in_labels());
+    }
+
+    void Serialization::SaveReachabilityIndex() {
+        const auto &reachability_data = tr_.GetReachabilityData();
+        auto &index_proto = *data_base_.mutable_router_core()->mutable_reachability_index();
+        index_proto.mutable_vertex_component()->Add(reachability_data.vertex_components.begin(),
+                                                    reachability_data.vertex_components.end());
+        index_proto.set_component_count(reachability_data.component_count);
+        index_proto.mutable_reachable()->Add(reachability_data.reachable.begin(), reachability_data.reachable.end());
+    }
+
     void Serialization::LoadRouteSetting() {
         domain::RouteSettings settings;
 
         settings.bus_velocity = data_base_.router_core().route_setting().bus_velocity();
         settings.bus_wait_time = data_base_.router_core().route_setting().bus_wait_time();
+        settings.router_engine = static_cast<domain::RouterEngine>(data_base_.router_core().route_setting().router_engine());
+        settings.graph_model = static_cast<domain::GraphModel>(data_base_.router_core().route_setting().graph_model());
+        settings.route_cache_size = data_base_.router_core().route_setting().route_cache_size();
         tr_.SetRouteSettings(settings);
     }
 
 // Load methods
     void Serialization::LoadGraphs() {
-        LoadGraphVertex();
         LoadGraphEdge();
         LoadGraph();
-    }
-
-    void Serialization::LoadGraphVertex() {
-        std::unordered_map<domain::StopPtr, graph::VertexId> graph_vertexes;
-
-        for (int i = data_base_.router_core().graphs().graph_vertex_size() - 1; i >= 0; --i) {
-            auto vertex = data_base_.router_core().graphs().graph_vertex(i);
-            graph_vertexes[tc_.FindStop(vertex.stop_name())] = vertex.vertex_id();
-        }
-        tr_.SetGraphVertex(graph_vertexes);
-
+        LoadReachabilityIndex();
+        LoadRouter();
     }
 
     void Serialization::LoadGraphEdge() {
@@ -387,6 +542,9 @@ namespace serialization {
             travel_props.travel_duration.stops_number = edges.travel_duration().stop_number();
             travel_props.travel_duration.waiting_time = edges.travel_duration().waiting_time();
             travel_props.travel_duration.travel_time = edges.travel_duration().travel_time();
+            travel_props.kind = static_cast<transport_router::TravelKind>(edges.kind());
+            travel_props.distance = edges.distance();
+            travel_props.span_count = edges.span_count();
 
             graph_edges.push_back(travel_props);
         }
@@ -395,39 +553,171 @@ namespace serialization {
     }
 
     void Serialization::LoadGraph() {
-        std::vector<graph::Edge<transport_router::TravelDuration>> edges;
-
-        auto graph_proto = data_base_.router_core().graphs().graph();
-        for (int i = 0; i < graph_proto.edges_in_graph_size(); ++i) {
-            auto edge_proto = graph_proto.edges_in_graph(i);
-            graph::Edge<transport_router::TravelDuration> edge;
+        const auto &graph_proto = data_base_.router_core().graphs().graph();
+        const size_t edge_count = graph_proto.edge_to_size();
+        if (graph_proto.edge_offsets_size() == 0
+            || static_cast<size_t>(graph_proto.stop_number_size()) != edge_count
+            || static_cast<size_t>(graph_proto.waiting_time_size()) != edge_count
+            || static_cast<size_t>(graph_proto.travel_time_size()) != edge_count) {
+            throw std::runtime_error("Corrupted graph");
+        }
 
-            edge.from = edge_proto.edge_from();
-            edge.to = edge_proto.edge_to();
+        std::vector<size_t> edge_offsets(graph_proto.edge_offsets().begin(), graph_proto.edge_offsets().end());
+        std::vector<graph::Edge<transport_router::RouteWeight>> edges(edge_count);
+        for (graph::VertexId vertex = 0; vertex + 1 < edge_offsets.size(); ++vertex) {
+            for (size_t i = edge_offsets[vertex]; i < edge_offsets[vertex + 1] && i < edge_count; ++i) {
+                edges[i].from = vertex;
+            }
+        }
+        for (size_t i = 0; i < edge_count; ++i) {
+            edges[i].to = graph_proto.edge_to(i);
+            edges[i].weight = transport_router::RouteWeight(graph_proto.stop_number(i), graph_proto.waiting_time(i),
+                                                            graph_proto.travel_time(i));
+        }
 
-            edge.weight.stops_number = edge_proto.weight_graph().stop_number();
-            edge.weight.travel_time = edge_proto.weight_graph().travel_time();
-            edge.weight.waiting_time = edge_proto.weight_graph().waiting_time();
+        graph::DirectedWeightedGraph<transport_router::RouteWeight> graph(std::move(edges), std::move(edge_offsets));
+        tr_.SetGraph(graph);
+    }
 
-            edges.push_back(edge);
+    void Serialization::LoadRouter() {
+        if (data_base_.router_core().has_routes_internal_data()) {
+            LoadRoutesInternalData();
+        } else if (data_base_.router_core().has_compact_routes_internal_data()) {
+            LoadCompactRoutesInternalData();
+        } else if (data_base_.router_core().has_contraction_hierarchy()) {
+            LoadContractionHierarchy();
+        } else if (data_base_.router_core().has_overlay_partition()) {
+            LoadOverlayPartition();
+        } else if (data_base_.router_core().has_hub_labels()) {
+            LoadHubLabels();
+        } else {
+            tr_.BuildRouter();
         }
+    }
 
-        std::vector<std::vector<graph::EdgeId>> incidence_lists;
+    void Serialization::LoadReachabilityIndex() {
+        if (!data_base_.router_core().has_reachability_index()) {
+            return;
+        }
+        const auto &index_proto = data_base_.router_core().reachability_index();
+        transport_router::TransportRouter::ReachabilityData reachability_data{
+                {index_proto.vertex_component().begin(), index_proto.vertex_component().end()},
+                index_proto.component_count(),
+                {index_proto.reachable().begin(), index_proto.reachable().end()}};
+        tr_.SetReachabilityData(reachability_data);
+    }
+
+    void Serialization::LoadRoutesInternalData() {
+        const auto &data_proto = data_base_.router_core().routes_internal_data();
+        const size_t vertex_count = data_proto.vertex_count();
+        if (static_cast<size_t>(data_proto.prev_edge_size()) != vertex_count * vertex_count) {
+            throw std::runtime_error("Corrupted routes internal data");
+        }
+        //Weights are kept for the reachable cells only
+        const auto reachable_count = std::count_if(data_proto.prev_edge().begin(), data_proto.prev_edge().end(),
+                                                   [](uint64_t prev_edge) { return prev_edge != 0; });
+        if (data_proto.stop_number_size() != reachable_count || data_proto.waiting_time_size() != reachable_count
+            || data_proto.travel_time_size() != reachable_count) {
+            throw std::runtime_error("Corrupted routes internal data");
+        }
 
-        for (int i = 0; i < graph_proto.incidence_lists_size(); ++i) {
-            auto list_proto = graph_proto.incidence_lists(i);
-            std::vector<graph::EdgeId> incidence_list;
-            for (int y = 0; y < list_proto.incidence_list_size(); ++y) {
-                incidence_list.push_back(list_proto.incidence_list(y));
+        transport_router::TransportRouter::RoutesInternalData routes_internal_data(
+                vertex_count, std::vector<std::optional<graph::Router<transport_router::RouteWeight>::RouteInternalData>>(vertex_count));
+
+        int cell_index = 0;
+        int weight_index = 0;
+        for (auto &row: routes_internal_data) {
+            for (auto &cell: row) {
+                const uint64_t prev_edge = data_proto.prev_edge(cell_index++);
+                if (prev_edge == 0) {
+                    continue;
+                }
+                transport_router::RouteWeight weight(data_proto.stop_number(weight_index),
+                                                     data_proto.waiting_time(weight_index),
+                                                     data_proto.travel_time(weight_index));
+                ++weight_index;
+                cell = graph::Router<transport_router::RouteWeight>::RouteInternalData{
+                        weight, prev_edge == 1 ? std::nullopt : std::optional<graph::EdgeId>(prev_edge - 2)};
             }
-            incidence_lists.push_back(incidence_list);
         }
 
-        graph::DirectedWeightedGraph<transport_router::TravelDuration> graph;
-        graph.SetEdge(edges);
-        graph.SetIncidenceList(incidence_lists);
+        tr_.SetRoutesInternalData(routes_internal_data);
+    }
 
-        tr_.SetGraph(graph);
+    void Serialization::LoadCompactRoutesInternalData() {
+        using CompactRouter = graph::CompactRouter<transport_router::RouteWeight>;
+
+        const auto &data_proto = data_base_.router_core().compact_routes_internal_data();
+        const size_t vertex_count = data_proto.vertex_count();
+        if (static_cast<size_t>(data_proto.prev_edge_size()) != vertex_count * vertex_count
+            || data_proto.weight_size() != data_proto.prev_edge_size()) {
+            throw std::runtime_error("Corrupted routes internal data");
+        }
+
+        transport_router::TransportRouter::CompactRoutesInternalData routes_internal_data(vertex_count * vertex_count);
+        for (int i = 0; i < data_proto.prev_edge_size(); ++i) {
+            const uint32_t prev_edge = data_proto.prev_edge(i);
+            const uint32_t weight = data_proto.weight(i);
+            routes_internal_data[i].prev_edge = prev_edge == 0 ? CompactRouter::NO_EDGE : prev_edge - 1;
+            routes_internal_data[i].weight = weight == 0 ? CompactRouter::UNREACHABLE : weight - 1;
+        }
+
+        tr_.SetCompactRoutesInternalData(routes_internal_data);
+    }
+
+    void Serialization::LoadContractionHierarchy() {
+        const auto &hierarchy_proto = data_base_.router_core().contraction_hierarchy();
+        if (hierarchy_proto.shortcut_first_arc_size() != hierarchy_proto.shortcut_second_arc_size()) {
+            throw std::runtime_error("Corrupted contraction hierarchy");
+        }
+
+        transport_router::TransportRouter::HierarchyData hierarchy_data;
+        hierarchy_data.vertex_ranks.assign(hierarchy_proto.vertex_rank().begin(), hierarchy_proto.vertex_rank().end());
+        hierarchy_data.shortcuts.reserve(hierarchy_proto.shortcut_first_arc_size());
+        for (int i = 0; i < hierarchy_proto.shortcut_first_arc_size(); ++i) {
+            hierarchy_data.shortcuts.push_back({hierarchy_proto.shortcut_first_arc(i),
+                                                hierarchy_proto.shortcut_second_arc(i)});
+        }
+
+        tr_.SetHierarchyData(hierarchy_data);
     }
-}
 
+    void Serialization::LoadOverlayPartition() {
+        transport_router::TransportRouter::OverlayPartition overlay_partition;
+        for (const auto &level_proto: data_base_.router_core().overlay_partition().level()) {
+            overlay_partition.emplace_back(level_proto.cell_id().begin(), level_proto.cell_id().end());
+        }
+
+        tr_.SetOverlayPartition(overlay_partition);
+    }
+
+    void Serialization::LoadHubLabels() {
+        using HubLabels = graph::HubLabels<transport_router::RouteWeight>;
+
+        const auto load_labels = [](const router_proto::Hub_Label_Set &labels_proto) {
+            const int entry_count = labels_proto.hub_size();
+            if (labels_proto.edge_size() != entry_count || labels_proto.stop_number_size() != entry_count
+                || labels_proto.waiting_time_size() != entry_count || labels_proto.travel_time_size() != entry_count) {
+                throw std::runtime_error("Corrupted hub labels");
+            }
+
+            HubLabels::Labels labels;
+            labels.offsets.assign(labels_proto.offset().begin(), labels_proto.offset().end());
+            labels.entries.reserve(entry_count);
+            for (int i = 0; i < entry_count; ++i) {
+                const uint64_t edge = labels_proto.edge(i);
+                labels.entries.push_back({labels_proto.hub(i),
+                                          transport_router::RouteWeight(labels_proto.stop_number(i),
+                                                                        labels_proto.waiting_time(i),
+                                                                        labels_proto.travel_time(i)),
+                                          edge == 0 ? HubLabels::NO_EDGE : edge - 1});
+            }
+            return labels;
+        };
+
+        const auto &hub_labels_proto = data_base_.router_core().hub_labels();
+        transport_router::TransportRouter::HubLabelData hub_label_data{load_labels(hub_labels_proto.out_labels()),
+                                                                       load_labels(hub_labels_proto.in_labels())};
+        tr_.SetHubLabelData(hub_label_data);
+    }
+}
@@ -45,6 +45,7 @@ namespace serialization {
         void SaveStops();
         void SaveBuses();
         void SaveDistance();
+        void SaveStopIndex();
 
         svg_proto::Point SavePoint(const svg::Point &point);
         svg_proto::Color SaveColor(const svg::Color &color);
@@ -55,9 +56,14 @@ namespace serialization {
         void SaveRouteSetting();
 
         void SaveGraphs();
-        void SaveGraphVertex();
         void SaveGraphEdge();
         void SaveGraph();
+        void SaveRoutesInternalData();
+        void SaveCompactRoutesInternalData();
+        void SaveContractionHierarchy();
+        void SaveOverlayPartition();
+        void SaveHubLabels();
+        void SaveReachabilityIndex();
 
         void LoadStop(const tc_serialize::Stop &stop);
         void LoadBus(const tc_serialize::Bus &bus);
@@ -66,6 +72,8 @@ namespace serialization {
         void LoadStops();
         void LoadBuses();
         void LoadDistance();
+        void LoadBusStats();
+        void LoadStopIndex();
 
         void LoadRenderSettings();
 
@@ -77,9 +85,15 @@ namespace serialization {
         void LoadRouteSetting();
 
         void LoadGraphs();
-        void LoadGraphVertex();
         void LoadGraphEdge();
         void LoadGraph();
+        void LoadRouter();
+        void LoadRoutesInternalData();
+        void LoadCompactRoutesInternalData();
+        void LoadContractionHierarchy();
+        void LoadOverlayPartition();
+        void LoadHubLabels();
+        void LoadReachabilityIndex();
 
     };
 
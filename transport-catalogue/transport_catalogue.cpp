@@ -1,11 +1,122 @@
 #include "transport_catalogue.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
 
 namespace transport_catalogue {
 
+    namespace {
+
+        constexpr uint32_t HILBERT_SIDE = 1u << 16;
+
+        //Position of the cell on the Hilbert curve filling the HILBERT_SIDE x HILBERT_SIDE grid
+        uint64_t GetHilbertIndex(uint32_t x, uint32_t y) {
+            uint64_t index = 0;
+            for (uint32_t side = HILBERT_SIDE / 2; side > 0; side /= 2) {
+                const uint32_t right = (x & side) > 0 ? 1 : 0;
+                const uint32_t top = (y & side) > 0 ? 1 : 0;
+                index += static_cast<uint64_t>(side) * side * ((3 * right) ^ top);
+                //The quadrant is rotated so that the curve inside it starts where it enters
+                if (top == 0) {
+                    if (right == 1) {
+                        x = HILBERT_SIDE - 1 - x;
+                        y = HILBERT_SIDE - 1 - y;
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return index;
+        }
+
+        std::vector<uint32_t> ToGridCells(const std::vector<double> &values) {
+            std::vector<uint32_t> cells(values.size(), 0);
+            const auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
+            if (min_it == values.end() || !(*max_it > *min_it)) {
+                return cells;
+            }
+            for (size_t i = 0; i < values.size(); ++i) {
+                cells[i] = static_cast<uint32_t>((values[i] - *min_it) / (*max_it - *min_it) * (HILBERT_SIDE - 1));
+            }
+            return cells;
+        }
+
+    }
+
     void TransportCatalogue::AddStop(std::string_view stop_name, geo::Coordinates coordinates) {
-        const auto &stop = stops_.emplace_back(domain::Stop{std::string(stop_name), coordinates});
+        const auto stop_id = static_cast<domain::StopId>(stops_by_id_.size());
+        const auto &stop = stops_.emplace_back(domain::Stop{std::string(stop_name), coordinates, stop_id});
         stop_binding_.insert({stop.name, &stop});
-        buses_in_stop_[&stop];
+        stops_by_id_.push_back(&stop);
+        stop_latitudes_.push_back(coordinates.lat);
+        stop_longitudes_.push_back(coordinates.lng);
+        buses_in_stop_.emplace_back();
+        stop_index_ = {};
+    }
+
+    void TransportCatalogue::SortStopsByLocation() {
+        if (!bus_.empty() || !pending_distances_.empty() || !distance_targets_.empty()) {
+            throw std::logic_error("Stops can't be renumbered after buses and distances are added");
+        }
+        const auto x_cells = ToGridCells(stop_longitudes_);
+        const auto y_cells = ToGridCells(stop_latitudes_);
+        std::vector<uint64_t> curve_indexes(stops_by_id_.size());
+        for (size_t i = 0; i < stops_by_id_.size(); ++i) {
+            curve_indexes[i] = GetHilbertIndex(x_cells[i], y_cells[i]);
+        }
+
+        std::vector<domain::StopId> order(stops_by_id_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](domain::StopId lhs, domain::StopId rhs) {
+            return curve_indexes[lhs] != curve_indexes[rhs] ? curve_indexes[lhs] < curve_indexes[rhs]
+                                                            : stops_by_id_[lhs]->name < stops_by_id_[rhs]->name;
+        });
+
+        std::vector<domain::StopId> new_ids(order.size());
+        for (domain::StopId stop_id = 0; stop_id < order.size(); ++stop_id) {
+            new_ids[order[stop_id]] = stop_id;
+        }
+        for (auto &stop: stops_) {
+            stop.id = new_ids[stop.id];
+            stops_by_id_[stop.id] = &stop;
+            stop_latitudes_[stop.id] = stop.coordinates.lat;
+            stop_longitudes_[stop.id] = stop.coordinates.lng;
+        }
+        stop_index_ = {};
+    }
+
+    void TransportCatalogue::BuildStopIndex() {
+        stop_index_ = geo::GridIndex(stop_latitudes_, stop_longitudes_);
+    }
+
+    void TransportCatalogue::SetStopIndex(geo::GridIndex::IndexData index_data) {
+        stop_index_ = geo::GridIndex(stop_latitudes_, stop_longitudes_, std::move(index_data));
+    }
+
+    std::vector<std::pair<domain::StopPtr, double>> TransportCatalogue::FindNearestStops(geo::Coordinates position,
+                                                                                         size_t count) const {
+        return ToStops(stop_index_.FindNearest(position, count));
+    }
+
+    std::vector<std::pair<domain::StopPtr, double>> TransportCatalogue::FindStopsInRadius(geo::Coordinates position,
+                                                                                          double radius) const {
+        return ToStops(stop_index_.FindInRadius(position, radius));
+    }
+
+    std::vector<std::pair<domain::StopPtr, double>>
+    TransportCatalogue::ToStops(const std::vector<geo::GridIndex::Neighbour> &neighbours) const {
+        if (stop_index_.GetPointCount() != stops_by_id_.size()) {
+            throw std::logic_error("Stop index isn't built");
+        }
+        std::vector<std::pair<domain::StopPtr, double>> result;
+        result.reserve(neighbours.size());
+        for (const auto &neighbour: neighbours) {
+            result.emplace_back(stops_by_id_[neighbour.point], neighbour.distance);
+        }
+        return result;
     }
 
     domain::StopPtr TransportCatalogue::FindStop(std::string_view stop_name) const{
@@ -21,13 +132,18 @@ namespace transport_catalogue {
         std::vector<domain::StopPtr> route_stops;
         route_stops.reserve(stops.size());
 
-        auto &route = bus_.emplace_back(domain::Bus{std::string(bus_name), route_stops, is_circle});
+        const auto bus_id = static_cast<domain::BusId>(bus_.size());
+        auto &route = bus_.emplace_back(domain::Bus{std::string(bus_name), route_stops, is_circle, bus_id});
         bus_binding_.insert({route.bus_name, &route});
+        buses_by_name_[route.bus_name] = &route;
         for (const auto &stop: stops) {
             const auto *stop_find = FindStop(stop);
             route.bus_stops.push_back(stop_find);
-            buses_in_stop_[stop_find].insert(FindBus(bus_name));
+            bus_stop_ids_.push_back(stop_find->id);
+            buses_in_stop_[stop_find->id].insert(&route);
         }
+        bus_stop_offsets_.push_back(bus_stop_ids_.size());
+        bus_stats_.clear();
     }
 
     domain::BusPtr TransportCatalogue::FindBus(std::string_view bus_name) const {
@@ -40,91 +156,177 @@ namespace transport_catalogue {
     }
 
     const std::optional<Buses_Info> TransportCatalogue::GetBusInfo(std::string input) const {
-        Buses_Info result;
         const auto *buses_info = FindBus(input);
         if (buses_info == nullptr) {
             return {};
         }
-        std::vector<domain::StopPtr> stops_in_route{buses_info->bus_stops.begin(), buses_info->bus_stops.end()};
-        std::unordered_set<domain::StopPtr> unique_stop;
-        std::for_each(
-                stops_in_route.begin(), stops_in_route.end(),
-                [&unique_stop](const auto &stop) {
-                    if (!unique_stop.count(stop)) {
-                        unique_stop.insert(stop);
-                    }
-                });
-        if (!buses_info->is_circle) {
-            stops_in_route.insert(stops_in_route.end(), std::next(buses_info->bus_stops.rbegin()),
-                                  buses_info->bus_stops.rend());
-        }
-        double route_length = 0.0;
-        size_t route_length_true = 0;
-        for (auto it = stops_in_route.begin(); it != std::prev(stops_in_route.end()); ++it) {
-            route_length += ComputeDistance((*it)->coordinates, (*(it + 1))->coordinates);
-            route_length_true += GetDistance(*it, *(it + 1));
+        BusStats bus_stats;
+        if (bus_stats_.size() == bus_.size()) {
+            bus_stats = bus_stats_[buses_info->id];
+        } else {
+            std::vector<bool> is_counted(stops_by_id_.size(), false);
+            bus_stats = CountBusStats(buses_info->id, is_counted);
         }
+
+        Buses_Info result;
         result.route_name = buses_info->bus_name;
-        result.stop_count = static_cast<int>(stops_in_route.size());
-        result.unique_stop = static_cast<int>(unique_stop.size());
-        result.route_length = route_length_true;
-        result.curvature = route_length_true / route_length;
+        result.stop_count = static_cast<int>(bus_stats.stop_count);
+        result.unique_stop = static_cast<int>(bus_stats.unique_stop_count);
+        result.route_length = static_cast<double>(bus_stats.route_length);
+        result.curvature = bus_stats.curvature;
 
         return result;
     }
 
+    void TransportCatalogue::ComputeBusStats() {
+        if (!pending_distances_.empty()) {
+            throw std::logic_error("Road distances aren't frozen");
+        }
+        std::vector<BusStats> bus_stats(bus_.size());
+        size_t thread_count = bus_.size() < PARALLEL_MIN_BUS_COUNT ? 1 : parallel::GetThreadCount();
+        thread_count = std::max<size_t>(1, std::min(thread_count, bus_.size()));
+        std::vector<std::vector<bool>> is_counted(thread_count);
+        parallel::RunStealingTasks(bus_.size(), thread_count, [&](size_t thread_index, size_t bus_id) {
+            auto &thread_is_counted = is_counted[thread_index];
+            if (thread_is_counted.empty()) {
+                thread_is_counted.assign(stops_by_id_.size(), false);
+            }
+            bus_stats[bus_id] = CountBusStats(static_cast<domain::BusId>(bus_id), thread_is_counted);
+        });
+        bus_stats_ = std::move(bus_stats);
+    }
+
+    void TransportCatalogue::SetBusStats(std::vector<BusStats> bus_stats) {
+        if (bus_stats.size() != bus_.size()) {
+            throw std::invalid_argument("Bus statistics don't match the buses");
+        }
+        bus_stats_ = std::move(bus_stats);
+    }
+
+    BusStats TransportCatalogue::CountBusStats(domain::BusId bus_id, std::vector<bool> &is_counted) const {
+        BusStats result;
+        const auto stop_ids = GetBusStopIds(bus_id);
+        if (stop_ids.begin() == stop_ids.end()) {
+            return result;
+        }
+        for (const domain::StopId stop_id: stop_ids) {
+            if (!is_counted[stop_id]) {
+                is_counted[stop_id] = true;
+                ++result.unique_stop_count;
+            }
+        }
+        for (const domain::StopId stop_id: stop_ids) {
+            is_counted[stop_id] = false;
+        }
+
+        //The way back of a non-circular bus goes through the same stops in reverse
+        double geo_length = 0.0;
+        const auto add_segment = [&](domain::StopId from, domain::StopId to) {
+            geo_length += geo::ComputeDistance({stop_latitudes_[from], stop_longitudes_[from]},
+                                               {stop_latitudes_[to], stop_longitudes_[to]});
+            result.route_length += GetDistance(from, to);
+        };
+        const size_t stops_count = stop_ids.end() - stop_ids.begin();
+        for (const domain::StopId *it = stop_ids.begin(); it + 1 != stop_ids.end(); ++it) {
+            add_segment(*it, *(it + 1));
+        }
+        result.stop_count = static_cast<uint32_t>(stops_count);
+        if (!bus_[bus_id].is_circle) {
+            for (const domain::StopId *it = stop_ids.end() - 1; it != stop_ids.begin(); --it) {
+                add_segment(*it, *(it - 1));
+            }
+            result.stop_count = static_cast<uint32_t>(2 * stops_count - 1);
+        }
+        result.curvature = result.route_length / geo_length;
+        return result;
+    }
+
     const std::unordered_set<domain::BusPtr>* TransportCatalogue::GetStopInfo(std::string_view input) const{
-        if (FindStop(input)) {
-            return &buses_in_stop_.at(FindStop(input));
+        if (const domain::StopPtr stop = FindStop(input)) {
+            return &buses_in_stop_[stop->id];
         } else {
             return nullptr;
         }
     }
 
-    void TransportCatalogue::SetDistanceStops(domain::StopPtr first_stop, domain::StopPtr second_stop, double distance) {
-        std::pair<domain::StopPtr, domain::StopPtr> stop_pair = std::make_pair(first_stop, second_stop);
-        distance_between_stop_[stop_pair] = distance;
+    void TransportCatalogue::SetDistanceStops(domain::StopPtr first_stop, domain::StopPtr second_stop, uint32_t distance) {
+        pending_distances_.push_back({first_stop->id, second_stop->id, distance, true});
     }
 
-    size_t TransportCatalogue::GetDistance(domain::StopPtr first_stop, domain::StopPtr second_stop) const{
-        auto pair_stop = std::make_pair(first_stop, second_stop);
-        if (distance_between_stop_.find(pair_stop) != distance_between_stop_.end()) {
-            return distance_between_stop_.at(pair_stop);
+    void TransportCatalogue::FreezeDistances() {
+        //The table already built takes part as the earliest given distances
+        std::vector<RoadDistance> distances;
+        distances.reserve(distance_targets_.size() + 2 * pending_distances_.size());
+        for (domain::StopId from = 0; from + 1 < distance_offsets_.size(); ++from) {
+            for (size_t i = distance_offsets_[from]; i < distance_offsets_[from + 1]; ++i) {
+                distances.push_back({from, distance_targets_[i], distance_values_[i], distance_is_given_[i]});
+            }
         }
-        return GetDistance(second_stop, first_stop);
-    }
+        distances.insert(distances.end(), pending_distances_.begin(), pending_distances_.end());
+        for (const auto &road_distance: pending_distances_) {
+            distances.push_back({road_distance.to, road_distance.from, road_distance.distance, false});
+        }
+        pending_distances_.clear();
+        pending_distances_.shrink_to_fit();
+        bus_stats_.clear();
 
-    const std::map<std::string_view, domain::BusPtr> TransportCatalogue::GetAllBusesInfo() const {
-        std::map<std::string_view, domain::BusPtr> result;
-        for (const auto& bus : bus_) {
-            result[bus.bus_name] = &bus;
+        //For every pair the latest given distance wins, the other direction is used if none is given
+        std::stable_sort(distances.begin(), distances.end(), [](const RoadDistance &lhs, const RoadDistance &rhs) {
+            return std::tie(lhs.from, lhs.to, lhs.is_given) < std::tie(rhs.from, rhs.to, rhs.is_given);
+        });
+
+        distance_offsets_.assign(stops_by_id_.size() + 1, 0);
+        distance_targets_.clear();
+        distance_values_.clear();
+        distance_is_given_.clear();
+        for (size_t i = 0; i < distances.size(); ++i) {
+            const RoadDistance &road_distance = distances[i];
+            if (i + 1 < distances.size() && distances[i + 1].from == road_distance.from
+                && distances[i + 1].to == road_distance.to) {
+                continue;
+            }
+            ++distance_offsets_[road_distance.from + 1];
+            distance_targets_.push_back(road_distance.to);
+            distance_values_.push_back(road_distance.distance);
+            distance_is_given_.push_back(road_distance.is_given);
+        }
+        for (size_t stop_id = 0; stop_id < stops_by_id_.size(); ++stop_id) {
+            distance_offsets_[stop_id + 1] += distance_offsets_[stop_id];
         }
-        return result;
     }
 
-    const std::unordered_map<std::string_view, domain::StopPtr> TransportCatalogue::GetAllStop() const {
-        return stop_binding_;
+    size_t TransportCatalogue::GetDistance(domain::StopPtr first_stop, domain::StopPtr second_stop) const {
+        return GetDistance(first_stop->id, second_stop->id);
     }
 
-    const std::deque<domain::Stop> TransportCatalogue::GetStopBase() const {
-        return stops_;
+    size_t TransportCatalogue::GetDistance(domain::StopId first_stop, domain::StopId second_stop) const {
+        if (!pending_distances_.empty()) {
+            throw std::logic_error("Road distances aren't frozen");
+        }
+        if (first_stop + 1 < distance_offsets_.size()) {
+            const auto begin = distance_targets_.begin() + distance_offsets_[first_stop];
+            const auto end = distance_targets_.begin() + distance_offsets_[first_stop + 1];
+            const auto it = std::lower_bound(begin, end, second_stop);
+            if (it != end && *it == second_stop) {
+                return distance_values_[it - distance_targets_.begin()];
+            }
+        }
+        throw std::out_of_range("Road distance between the stops is unknown");
     }
 
-    const std::deque<domain::Bus> TransportCatalogue::GetBusBase() const {
-        return bus_;
+    const std::map<std::string_view, domain::BusPtr>& TransportCatalogue::GetAllBusesInfo() const {
+        return buses_by_name_;
     }
 
-    const std::unordered_map<domain::StopPtr, std::unordered_set<domain::BusPtr>>
-    TransportCatalogue::GetBusesInStopBase() const {
-        return buses_in_stop_;
+    const std::unordered_map<std::string_view, domain::StopPtr>& TransportCatalogue::GetAllStop() const {
+        return stop_binding_;
     }
 
-    const std::unordered_map<std::pair<domain::StopPtr, domain::StopPtr>, double, detail::DistanceHasher>
-    TransportCatalogue::GetDistanceBase() const {
-        return distance_between_stop_;
+    const std::vector<domain::StopPtr>& TransportCatalogue::GetStopBase() const {
+        return stops_by_id_;
     }
 
-    size_t detail::DistanceHasher::operator()(const std::pair<domain::StopPtr, domain::StopPtr> stops_pair) const {
-        return hasher(stops_pair.first) + hasher(stops_pair.second) * 37;
+    const std::deque<domain::Bus>& TransportCatalogue::GetBusBase() const {
+        return bus_;
     }
 }
@@ -2,6 +2,9 @@
 
 #include "geo.h"
 #include "domain.h"
+#include "grid_index.h"
+#include "ranges.h"
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -24,14 +27,13 @@ namespace transport_catalogue {
         double curvature;
     };
 
-    namespace detail {
-        struct DistanceHasher {
-            size_t operator()(const std::pair<domain::StopPtr, domain::StopPtr> stops_pair) const;
-
-        private:
-            std::hash<const void *> hasher;
-        };
-    }
+    //Figures of a Bus request, computed once for all buses by ComputeBusStats
+    struct BusStats {
+        uint32_t stop_count = 0;            //stops of the way there and back
+        uint32_t unique_stop_count = 0;
+        uint64_t route_length = 0;          //road length in meters
+        double curvature = 0.0;             //road length to great-circle length
+    };
 
     class TransportCatalogue {
     public:
@@ -42,30 +44,134 @@ namespace transport_catalogue {
         domain::StopPtr FindStop(std::string_view stop_name) const;
         domain::BusPtr FindBus(std::string_view bus_name) const;
 
-        void SetDistanceStops(domain::StopPtr first_stop, domain::StopPtr second_stop, double distance);
+        //Road distances in meters. They are collected until FreezeDistances builds the lookup table,
+        //a distance given in one direction only is used for both.
+        void SetDistanceStops(domain::StopPtr first_stop, domain::StopPtr second_stop, uint32_t distance);
+        void FreezeDistances();
+
+        //Renumbers the stops along a Hilbert curve over their coordinates, so stops close to each other
+        //get close ids. Only stops may be added before.
+        void SortStopsByLocation();
+
+        //Fills the statistics of every bus, the buses are spread over the threads. Distances must be frozen.
+        void ComputeBusStats();
+        //Statistics indexed by bus id, as ComputeBusStats fills them
+        void SetBusStats(std::vector<BusStats> bus_stats);
+        const std::vector<BusStats>& GetBusStats() const {
+            return bus_stats_;
+        }
+
+        //Grid over the stop coordinates for the nearest stop searches. Stops added later drop it.
+        void BuildStopIndex();
+        void SetStopIndex(geo::GridIndex::IndexData index_data);
+        const geo::GridIndex& GetStopIndex() const {
+            return stop_index_;
+        }
+
+        //Stops with their great-circle distances in meters, ordered by distance
+        std::vector<std::pair<domain::StopPtr, double>> FindNearestStops(geo::Coordinates position, size_t count) const;
+        std::vector<std::pair<domain::StopPtr, double>> FindStopsInRadius(geo::Coordinates position, double radius) const;
 
         const std::optional<Buses_Info> GetBusInfo(std::string input) const;
         const std::unordered_set<domain::BusPtr>* GetStopInfo(std::string_view input) const;
         size_t GetDistance(domain::StopPtr first_stop, domain::StopPtr second_stop) const;
+        size_t GetDistance(domain::StopId first_stop, domain::StopId second_stop) const;
+
+        //Views of the catalogue's own storage, nothing is copied. Buses by name are kept sorted as they're added.
+        const std::map<std::string_view, domain::BusPtr>& GetAllBusesInfo() const;
+        const std::unordered_map<std::string_view, domain::StopPtr>& GetAllStop() const;
+
+        //Stops and buses in the order of their ids
+        const std::vector<domain::StopPtr>& GetStopBase() const;
+        const std::deque<domain::Bus>& GetBusBase() const;
+        //Calls visitor(from, to, distance) for the distances as they were given, without the ones taken
+        //from the other direction
+        template <typename Visitor>
+        void ForEachGivenDistance(Visitor visitor) const;
+
+        size_t GetStopCount() const {
+            return stops_by_id_.size();
+        }
+
+        size_t GetBusCount() const {
+            return bus_.size();
+        }
 
-        const std::map<std::string_view, domain::BusPtr> GetAllBusesInfo() const;
-        const std::unordered_map<std::string_view, domain::StopPtr> GetAllStop() const;
+        domain::StopPtr GetStop(domain::StopId stop_id) const {
+            return stops_by_id_[stop_id];
+        }
 
-        const std::deque<domain::Stop> GetStopBase() const;
-        const std::deque<domain::Bus> GetBusBase() const;
-        const std::unordered_map<domain::StopPtr, std::unordered_set<domain::BusPtr>> GetBusesInStopBase() const;
-        const std::unordered_map<std::pair<domain::StopPtr, domain::StopPtr>, double, detail::DistanceHasher> GetDistanceBase() const;
+        domain::BusPtr GetBus(domain::BusId bus_id) const {
+            return &bus_[bus_id];
+        }
+
+        const std::vector<double>& GetStopLatitudes() const {
+            return stop_latitudes_;
+        }
+
+        const std::vector<double>& GetStopLongitudes() const {
+            return stop_longitudes_;
+        }
+
+        //Stop ids of the bus in the order of bus_stops
+        ranges::Range<const domain::StopId*> GetBusStopIds(domain::BusId bus_id) const {
+            return {bus_stop_ids_.data() + bus_stop_offsets_[bus_id], bus_stop_ids_.data() + bus_stop_offsets_[bus_id + 1]};
+        }
 
     private:
 
+        struct RoadDistance {
+            domain::StopId from;
+            domain::StopId to;
+            uint32_t distance;
+            bool is_given;
+        };
+
+        static constexpr size_t PARALLEL_MIN_BUS_COUNT = 256;
+
+        //is_counted is indexed by stop id, it's all false before and after the call
+        BusStats CountBusStats(domain::BusId bus_id, std::vector<bool> &is_counted) const;
+        std::vector<std::pair<domain::StopPtr, double>> ToStops(const std::vector<geo::GridIndex::Neighbour> &neighbours) const;
+
+        //Stop and Bus objects are the views behind StopPtr and BusPtr, the dense core is indexed by ids
         std::deque<domain::Stop> stops_;
         std::deque<domain::Bus> bus_;
-        
+
         std::unordered_map<std::string_view, domain::BusPtr> bus_binding_;
         std::unordered_map<std::string_view, domain::StopPtr> stop_binding_;
-        
-        std::unordered_map<domain::StopPtr, std::unordered_set<domain::BusPtr>> buses_in_stop_;
-        std::unordered_map<std::pair<domain::StopPtr, domain::StopPtr>, double, detail::DistanceHasher> distance_between_stop_;
+        std::map<std::string_view, domain::BusPtr> buses_by_name_;
+
+        std::vector<domain::StopPtr> stops_by_id_;
+        std::vector<double> stop_latitudes_;
+        std::vector<double> stop_longitudes_;
+        //Stops of bus b are [bus_stop_offsets_[b], bus_stop_offsets_[b + 1]) of bus_stop_ids_
+        std::vector<domain::StopId> bus_stop_ids_;
+        std::vector<size_t> bus_stop_offsets_{0};
+
+        std::vector<std::unordered_set<domain::BusPtr>> buses_in_stop_;
+        std::vector<RoadDistance> pending_distances_;
+        //Distances from stop s are [distance_offsets_[s], distance_offsets_[s + 1]), sorted by the target stop
+        std::vector<size_t> distance_offsets_;
+        std::vector<domain::StopId> distance_targets_;
+        std::vector<uint32_t> distance_values_;
+        std::vector<bool> distance_is_given_;
+        //Indexed by bus id, empty until ComputeBusStats or SetBusStats
+        std::vector<BusStats> bus_stats_;
+        geo::GridIndex stop_index_;
 
     };
+
+    template <typename Visitor>
+    void TransportCatalogue::ForEachGivenDistance(Visitor visitor) const {
+        for (domain::StopId from = 0; from + 1 < distance_offsets_.size(); ++from) {
+            for (size_t i = distance_offsets_[from]; i < distance_offsets_[from + 1]; ++i) {
+                if (distance_is_given_[i]) {
+                    visitor(stops_by_id_[from], stops_by_id_[distance_targets_[i]], distance_values_[i]);
+                }
+            }
+        }
+        for (const auto &road_distance: pending_distances_) {
+            visitor(stops_by_id_[road_distance.from], stops_by_id_[road_distance.to], road_distance.distance);
+        }
+    }
 }
@@ -6,8 +6,65 @@ namespace transport_router {
             : tc_(catalogue) {}
 
     void TransportRouter::SetRouteSettings(const domain::RouteSettings &settings) {
-        settings_.bus_velocity = settings.bus_velocity / 3.6;        //Convert km/h in m/s
-        settings_.bus_wait_time = settings.bus_wait_time * 60;        //Convert minutes in seconds
+        weight_params_ = MakeWeightParams(settings);
+        settings_ = settings;
+        route_cache_.SetCapacity(settings.route_cache_size);
+    }
+
+    void TransportRouter::UpdateRouteSettings(const domain::RouteSettings &settings) {
+        if (settings.graph_model != settings_.graph_model) {
+            throw std::invalid_argument("Graph model can't be changed without rebuilding the base");
+        }
+        //The loaded router stays if neither the weights nor the engine change
+        const bool is_reweighted = !(MakeWeightParams(settings) == weight_params_);
+        const bool is_engine_changed = settings.router_engine != settings_.router_engine;
+        SetRouteSettings(settings);
+        if (!is_reweighted && !is_engine_changed) {
+            return;
+        }
+
+        if (is_reweighted) {
+            auto edges = graph_.GetEdges();
+            auto edge_offsets = graph_.GetEdgeOffsets();
+            for (size_t i = 0; i < edges.size(); ++i) {
+                graph_edges_[i].travel_duration = EvaluateTravelDuration(graph_edges_[i], weight_params_);
+                edges[i].weight = ToRouteWeight(graph_edges_[i].travel_duration);
+            }
+            graph_ = graph::DirectedWeightedGraph<RouteWeight>(std::move(edges), std::move(edge_offsets));
+        }
+        BuildRouter();
+    }
+
+    bool WeightParams::operator==(const WeightParams &other) const {
+        return bus_velocity == other.bus_velocity && bus_wait_time == other.bus_wait_time;
+    }
+
+    WeightParams TransportRouter::MakeWeightParams(const domain::RouteSettings &settings) {
+        if (!(settings.bus_velocity > 0.0) || settings.bus_wait_time < 0) {
+            throw std::invalid_argument("Bus velocity should be positive and wait time non-negative");
+        }
+        return {settings.bus_velocity / 3.6,        //Convert km/h in m/s
+                settings.bus_wait_time * 60.0};     //Convert minutes in seconds
+    }
+
+    TravelDuration TransportRouter::EvaluateTravelDuration(const TravelProps &travel_unit,
+                                                           const WeightParams &weight_params) {
+        switch (travel_unit.kind) {
+            case TravelKind::BUS:
+                return {travel_unit.span_count, weight_params.bus_wait_time,
+                        travel_unit.distance / weight_params.bus_velocity};
+            case TravelKind::BOARDING:
+                return {0, weight_params.bus_wait_time, 0.0};
+            case TravelKind::RIDE:
+                return {travel_unit.span_count, 0.0, travel_unit.distance / weight_params.bus_velocity};
+            case TravelKind::ALIGHTING:
+                break;
+        }
+        return {};
+    }
+
+    size_t detail::VertexPairHasher::operator()(const std::pair<graph::VertexId, graph::VertexId> vertex_pair) const {
+        return hasher(vertex_pair.first) + hasher(vertex_pair.second) * 37;
     }
 
     DistanceCalc::DistanceCalc(const transport_catalogue::TransportCatalogue &tc,
@@ -48,56 +105,288 @@ namespace transport_router {
         return (lhs.waiting_time + lhs.travel_time > rhs.waiting_time + rhs.travel_time);
     }
 
-    void TransportRouter::FillGraphStop() {
-        auto all_stops = tc_.GetAllStop();
-        graph_ = graph::DirectedWeightedGraph<TravelDuration>(all_stops.size());
-        graph::VertexId vertex_counter = 0;
-
-        for (const auto &[_, stop_ptr]: all_stops) {
-            graph_vertexes_.insert({stop_ptr, vertex_counter++});
+    std::vector<domain::BusPtr> TransportRouter::GetBusesInGraphOrder() const {
+        //Bus chains follow the numbering of their first stops
+        std::vector<domain::BusPtr> buses;
+        for (const auto &[_, route_ptr]: tc_.GetAllBusesInfo()) {
+            buses.push_back(route_ptr);
         }
+        const auto first_vertex = [this](domain::BusPtr bus) {
+            return bus->bus_stops.empty() ? tc_.GetStopCount() : bus->bus_stops.front()->id;
+        };
+        std::stable_sort(buses.begin(), buses.end(), [&first_vertex](domain::BusPtr lhs, domain::BusPtr rhs) {
+            return first_vertex(lhs) < first_vertex(rhs);
+        });
+        return buses;
     }
 
     void TransportRouter::FillGraphBuses() {
+        graph_ = graph::DirectedWeightedGraph<RouteWeight>(tc_.GetStopCount());
+
         for (const auto &[_, route_ptr]: tc_.GetAllBusesInfo()) {
             const auto &stops = route_ptr->bus_stops;
 
             DistanceCalc distance_calc(tc_, route_ptr);
             for (int i = 0; i < stops.size() - 1; ++i) {
                 for (int j = i + 1; j < stops.size(); ++j) {
-                    TravelDuration travel_dur(j - i,
-                                              settings_.bus_wait_time,
-                                              distance_calc.DistanceBetweenStop(i, j) / settings_.bus_velocity);
-                    TravelProps travel_unit{stops[i], stops[j], route_ptr, travel_dur};
-                    graph_.AddEdge(
-                            graph::Edge<TravelDuration>{graph_vertexes_[travel_unit.from],
-                                                        graph_vertexes_[travel_unit.to],
-                                                        travel_dur});
-                    graph_edges_.push_back(std::move(travel_unit));
+                    AddGraphEdge(stops[i]->id, stops[j]->id,
+                                 TravelProps{stops[i], stops[j], route_ptr, {}, TravelKind::BUS,
+                                             distance_calc.DistanceBetweenStop(i, j), j - i});
 
                     if (!route_ptr->is_circle) {
-                        TravelDuration travel_dur(j - i,
-                                                  settings_.bus_wait_time,
-                                                  distance_calc.DistanceBetweenStop(j, i) / settings_.bus_velocity);
-                        TravelProps travel_unit{stops[i], stops[j], route_ptr, travel_dur};
-                        graph_.AddEdge(graph::Edge<TravelDuration>{graph_vertexes_[travel_unit.to],
-                                                                    graph_vertexes_[travel_unit.from], travel_dur});
-                        graph_edges_.push_back(std::move(travel_unit));
+                        AddGraphEdge(stops[j]->id, stops[i]->id,
+                                     TravelProps{stops[i], stops[j], route_ptr, {}, TravelKind::BUS,
+                                                 distance_calc.DistanceBetweenStop(j, i), j - i});
                     }
                 }
             }
         }
+    }
+
+    void TransportRouter::AddGraphEdge(graph::VertexId from, graph::VertexId to, TravelProps travel_unit) {
+        travel_unit.travel_duration = EvaluateTravelDuration(travel_unit, weight_params_);
+        graph_.AddEdge(graph::Edge<RouteWeight>{from, to, ToRouteWeight(travel_unit.travel_duration)});
+        graph_edges_.push_back(std::move(travel_unit));
+    }
+
+    void TransportRouter::FillExpandedGraphBuses() {
+        //Stop vertices go first, then one vertex per stop of every bus chain
+        const auto buses = GetBusesInGraphOrder();
+        size_t vertex_count = tc_.GetStopCount();
+        for (const domain::BusPtr route_ptr: buses) {
+            vertex_count += route_ptr->bus_stops.size() * (route_ptr->is_circle ? 1 : 2);
+        }
+        graph_ = graph::DirectedWeightedGraph<RouteWeight>(vertex_count);
+
+        graph::VertexId first_vertex = tc_.GetStopCount();
+        for (const domain::BusPtr route_ptr: buses) {
+            DistanceCalc distance_calc(tc_, route_ptr);
+            AddBusChain(route_ptr, distance_calc, true, first_vertex);
+            first_vertex += route_ptr->bus_stops.size();
+            if (!route_ptr->is_circle) {
+                AddBusChain(route_ptr, distance_calc, false, first_vertex);
+                first_vertex += route_ptr->bus_stops.size();
+            }
+        }
+    }
 
-        router_ = std::make_unique<graph::Router<TravelDuration>>(graph_);
+    void TransportRouter::FreezeGraph() {
+        //Edge ids change in the CSR layout, graph_edges_ follows them
+        const auto old_ids = graph_.Freeze();
+        std::vector<TravelProps> graph_edges(graph_edges_.size());
+        for (size_t i = 0; i < old_ids.size(); ++i) {
+            graph_edges[i] = std::move(graph_edges_[old_ids[i]]);
+        }
+        graph_edges_ = std::move(graph_edges);
+    }
+
+    void TransportRouter::AddBusChain(domain::BusPtr bus, DistanceCalc &distance_calc, bool is_forward,
+                                      graph::VertexId first_vertex) {
+        const auto &stops = bus->bus_stops;
+        const size_t stops_count = stops.size();
+        //Position of the k-th stop of the chain in bus_stops
+        auto position = [is_forward, stops_count](size_t k) {
+            return is_forward ? k : stops_count - 1 - k;
+        };
+
+        for (size_t k = 0; k < stops_count; ++k) {
+            const domain::StopPtr stop = stops[position(k)];
+            const graph::VertexId stop_vertex = stop->id;
+            const graph::VertexId bus_vertex = first_vertex + k;
+
+            if (k + 1 < stops_count) {
+                AddGraphEdge(stop_vertex, bus_vertex, TravelProps{stop, stop, bus, {}, TravelKind::BOARDING, 0, 0});
+
+                const domain::StopPtr next_stop = stops[position(k + 1)];
+                AddGraphEdge(bus_vertex, bus_vertex + 1,
+                             TravelProps{stop, next_stop, bus, {}, TravelKind::RIDE,
+                                         distance_calc.DistanceBetweenStop(position(k), position(k + 1)), 1});
+            }
+            if (k > 0) {
+                AddGraphEdge(bus_vertex, stop_vertex, TravelProps{stop, stop, bus, {}, TravelKind::ALIGHTING, 0, 0});
+            }
+        }
+    }
+
+    void TransportRouter::ResetRouterHelpers() {
+        route_cache_.Clear();
+        reweighted_router_ = std::make_unique<graph::DijkstraRouter<RouteWeight>>(graph_);
+        raptor_router_ = std::make_unique<RaptorRouter>(tc_);
+    }
+
+    void TransportRouter::BuildRouter() {
+        ResetRouterHelpers();
+        switch (settings_.router_engine) {
+            case domain::RouterEngine::ALL_PAIRS:
+                router_ = std::make_shared<graph::Router<RouteWeight>>(graph_);
+                break;
+            case domain::RouterEngine::ALL_PAIRS_SEARCH:
+                //Transit graphs are sparse, V searches beat the cubic relaxation
+                router_ = std::make_shared<graph::Router<RouteWeight>>(
+                        graph_, graph::Router<RouteWeight>::PerSourceSearch{});
+                break;
+            case domain::RouterEngine::DIJKSTRA:
+                router_ = std::make_shared<graph::DijkstraRouter<RouteWeight>>(graph_);
+                break;
+            case domain::RouterEngine::COMPACT_ALL_PAIRS:
+                router_ = std::make_shared<graph::CompactRouter<RouteWeight>>(graph_);
+                break;
+            case domain::RouterEngine::CONTRACTION_HIERARCHIES:
+                router_ = std::make_shared<graph::ContractionHierarchy<RouteWeight>>(graph_);
+                break;
+            case domain::RouterEngine::A_STAR:
+                PrepareLowerBound();
+                router_ = std::make_shared<graph::AStarRouter<RouteWeight>>(
+                        graph_, [this](graph::VertexId from, graph::VertexId to) {
+                            return GetLowerBound(from, to);
+                        });
+                break;
+            case domain::RouterEngine::MULTI_LEVEL_OVERLAY:
+                //The graph's topology doesn't change after it is built, only the cliques are customized again
+                if (overlay_partition_.empty() || overlay_partition_.front().size() != graph_.GetVertexCount()) {
+                    overlay_partition_ = MakeOverlayPartition();
+                }
+                router_ = std::make_shared<graph::MultiLevelOverlay<RouteWeight>>(graph_, overlay_partition_);
+                break;
+            case domain::RouterEngine::HUB_LABELS:
+                router_ = std::make_shared<graph::HubLabels<RouteWeight>>(graph_);
+                break;
+        }
+    }
+
+    void TransportRouter::FillVertexPoints() {
+        vertex_points_.assign(graph_.GetVertexCount(), geo::CartesianPoint{});
+        const auto &latitudes = tc_.GetStopLatitudes();
+        const auto &longitudes = tc_.GetStopLongitudes();
+        for (domain::StopId stop_id = 0; stop_id < tc_.GetStopCount(); ++stop_id) {
+            vertex_points_[stop_id] = geo::ToCartesian({latitudes[stop_id], longitudes[stop_id]});
+        }
+        //Bus vertices of the expanded graph model take the position of their stop
+        const auto &edges = graph_.GetEdges();
+        for (size_t i = 0; i < edges.size(); ++i) {
+            if (graph_edges_[i].kind == TravelKind::BOARDING) {
+                vertex_points_[edges[i].to] = geo::ToCartesian(graph_edges_[i].from->coordinates);
+            } else if (graph_edges_[i].kind == TravelKind::ALIGHTING) {
+                vertex_points_[edges[i].from] = geo::ToCartesian(graph_edges_[i].to->coordinates);
+            }
+        }
+    }
+
+    void TransportRouter::PrepareLowerBound() {
+        FillVertexPoints();
+
+        //Road distances may be shorter than the straight line, so the bound is calibrated on the edges
+        //themselves. Every edge covers its chord no faster than seconds_per_meter_ and every edge leaving
+        //a stop vertex waits at least stop_wait_time_, which keeps the bound consistent along any path.
+        seconds_per_meter_ = std::numeric_limits<double>::infinity();
+        stop_wait_time_ = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < graph_.GetEdgeCount(); ++i) {
+            const auto &edge = graph_.GetEdge(i);
+            const TravelDuration &duration = graph_edges_[i].travel_duration;
+            const double chord = geo::ComputeChordDistance(vertex_points_[edge.from], vertex_points_[edge.to]);
+            if (chord > 0.0) {
+                seconds_per_meter_ = std::min(seconds_per_meter_, duration.travel_time / chord);
+            }
+            if (edge.from < tc_.GetStopCount()) {
+                stop_wait_time_ = std::min(stop_wait_time_, duration.waiting_time);
+            }
+        }
+        if (std::isinf(seconds_per_meter_)) {
+            seconds_per_meter_ = 0.0;
+        }
+        if (std::isinf(stop_wait_time_)) {
+            stop_wait_time_ = 0.0;
+        }
+        //Guards against the rounding of the chords
+        seconds_per_meter_ *= 1.0 - 1e-9;
+    }
+
+    RouteWeight TransportRouter::GetLowerBound(graph::VertexId from, graph::VertexId to) const {
+        const double waiting_time = (from != to && from < tc_.GetStopCount()) ? stop_wait_time_ : 0.0;
+        return {0, waiting_time, geo::ComputeChordDistance(vertex_points_[from], vertex_points_[to]) * seconds_per_meter_};
+    }
+
+    namespace {
+
+        //Largest cell of every overlay level, the level is used only if the graph has more vertices
+        constexpr std::array<size_t, 3> OVERLAY_CELL_SIZES{64, 512, 4096};
+
+        double GetCoordinate(const geo::CartesianPoint &point, int axis) {
+            return axis == 0 ? point.x : (axis == 1 ? point.y : point.z);
+        }
+
+        //Kd-bisection: the vertices are split at the median of the widest coordinate until a part fits into
+        //a cell of the level, so every cell is a union of cells of the level below.
+        //Levels [0, open_levels) of the vertices in [begin, end) have no cell yet.
+        void BisectCells(const std::vector<geo::CartesianPoint> &points, std::vector<graph::VertexId>::iterator begin,
+                         std::vector<graph::VertexId>::iterator end, size_t open_levels,
+                         TransportRouter::OverlayPartition &partition, std::vector<uint32_t> &cell_counts) {
+            const size_t vertex_count = end - begin;
+            while (open_levels > 0 && vertex_count <= OVERLAY_CELL_SIZES[open_levels - 1]) {
+                --open_levels;
+                const uint32_t cell_id = cell_counts[open_levels]++;
+                for (auto it = begin; it != end; ++it) {
+                    partition[open_levels][*it] = cell_id;
+                }
+            }
+            if (open_levels == 0) {
+                return;
+            }
+
+            int widest_axis = 0;
+            double widest_extent = -1.0;
+            for (int axis = 0; axis < 3; ++axis) {
+                const auto [min_it, max_it] = std::minmax_element(begin, end, [&](graph::VertexId lhs, graph::VertexId rhs) {
+                    return GetCoordinate(points[lhs], axis) < GetCoordinate(points[rhs], axis);
+                });
+                const double extent = GetCoordinate(points[*max_it], axis) - GetCoordinate(points[*min_it], axis);
+                if (extent > widest_extent) {
+                    widest_extent = extent;
+                    widest_axis = axis;
+                }
+            }
+
+            const auto middle = begin + vertex_count / 2;
+            std::nth_element(begin, middle, end, [&](graph::VertexId lhs, graph::VertexId rhs) {
+                return GetCoordinate(points[lhs], widest_axis) < GetCoordinate(points[rhs], widest_axis);
+            });
+            BisectCells(points, begin, middle, open_levels, partition, cell_counts);
+            BisectCells(points, middle, end, open_levels, partition, cell_counts);
+        }
+
+    }
+
+    TransportRouter::OverlayPartition TransportRouter::MakeOverlayPartition() {
+        FillVertexPoints();
+        const size_t vertex_count = graph_.GetVertexCount();
+        const size_t level_count = std::count_if(OVERLAY_CELL_SIZES.begin(), OVERLAY_CELL_SIZES.end(),
+                                                 [vertex_count](size_t cell_size) {
+                                                     return cell_size < vertex_count;
+                                                 });
+        OverlayPartition partition(level_count, std::vector<uint32_t>(vertex_count, 0));
+        std::vector<uint32_t> cell_counts(level_count, 0);
+        std::vector<graph::VertexId> vertices(vertex_count);
+        std::iota(vertices.begin(), vertices.end(), 0);
+        BisectCells(vertex_points_, vertices.begin(), vertices.end(), level_count, partition, cell_counts);
+        return partition;
     }
 
     void TransportRouter::RouteInit(const domain::RouteSettings &settings) {
         SetRouteSettings(settings);
-        FillGraphStop();
-        FillGraphBuses();
+        switch (settings_.graph_model) {
+            case domain::GraphModel::COMPLETE:
+                FillGraphBuses();
+                break;
+            case domain::GraphModel::EXPANDED:
+                FillExpandedGraphBuses();
+                break;
+        }
+        FreezeGraph();
+        reachability_ = graph::ReachabilityIndex(graph_);
+        BuildRouter();
     }
 
-    std::optional<std::vector<const TravelProps *>>
+    std::optional<std::vector<TravelProps>>
     TransportRouter::FindRoute(std::string_view from, std::string_view to) const {
 
         domain::StopPtr stop_from = tc_.FindStop(from);
@@ -107,23 +396,243 @@ namespace transport_router {
             return std::nullopt;
         }
 
-        std::vector<const transport_router::TravelProps *> result;
         if (stop_from == stop_to) {
-            return result;
+            return std::vector<TravelProps>{};
+        }
+
+        graph::VertexId vertex_from = stop_from->id;
+        graph::VertexId vertex_to = stop_to->id;
+        if (!reachability_.IsReachable(vertex_from, vertex_to)) {
+            return std::nullopt;
+        }
+
+        const VertexPair vertex_pair{vertex_from, vertex_to};
+        auto route_edges = route_cache_.Get(vertex_pair);
+        if (!route_edges.has_value()) {
+            route_edges = MakeRouteEdges(vertex_pair, router_->BuildRoute(vertex_from, vertex_to));
+        }
+        if (!(*route_edges)->has_value()) {
+            return std::nullopt;
+        }
+
+        return MergeRouteItems((*route_edges)->value(), weight_params_);
+    }
+
+    std::optional<std::vector<TravelProps>>
+    TransportRouter::FindRoute(std::string_view from, std::string_view to, const domain::RouteSettings &settings) const {
+        const WeightParams weight_params = MakeWeightParams(settings);
+        if (weight_params == weight_params_) {
+            return FindRoute(from, to);
+        }
+
+        domain::StopPtr stop_from = tc_.FindStop(from);
+        domain::StopPtr stop_to = tc_.FindStop(to);
+
+        if (stop_from == nullptr || stop_to == nullptr) {
+            return std::nullopt;
         }
 
-        graph::VertexId vertex_from = graph_vertexes_.at(stop_from);
-        graph::VertexId vertex_to = graph_vertexes_.at(stop_to);
+        if (stop_from == stop_to) {
+            return std::vector<TravelProps>{};
+        }
+        if (!reachability_.IsReachable(stop_from->id, stop_to->id)) {
+            return std::nullopt;
+        }
 
-        auto route = router_->BuildRoute(vertex_from, vertex_to);
+        auto route = reweighted_router_->BuildRoute(
+                stop_from->id, stop_to->id,
+                [this, &weight_params](graph::EdgeId edge_id) {
+                    return ToRouteWeight(EvaluateTravelDuration(graph_edges_[edge_id], weight_params));
+                });
         if (!route.has_value()) {
             return std::nullopt;
         }
 
-        for (const auto &edge: route.value().edges) {
-            result.push_back(&graph_edges_.at(edge));
+        return MergeRouteItems(route.value().edges, weight_params);
+    }
+
+    std::vector<std::optional<std::vector<TravelProps>>>
+    TransportRouter::FindRoutes(std::string_view from, const std::vector<std::string_view> &to) const {
+
+        std::vector<std::optional<std::vector<TravelProps>>> result(to.size());
+        domain::StopPtr stop_from = tc_.FindStop(from);
+        if (stop_from == nullptr) {
+            return result;
+        }
+        graph::VertexId vertex_from = stop_from->id;
+
+        //Indexes of the requests that need the router and their vertices
+        std::vector<size_t> searched;
+        std::vector<graph::VertexId> targets;
+        for (size_t i = 0; i < to.size(); ++i) {
+            domain::StopPtr stop_to = tc_.FindStop(to[i]);
+            if (stop_to == nullptr) {
+                continue;
+            }
+            if (stop_to == stop_from) {
+                result[i] = std::vector<TravelProps>{};
+                continue;
+            }
+            graph::VertexId vertex_to = stop_to->id;
+            if (!reachability_.IsReachable(vertex_from, vertex_to)) {
+                continue;
+            }
+            if (auto route_edges = route_cache_.Get({vertex_from, vertex_to})) {
+                if ((*route_edges)->has_value()) {
+                    result[i] = MergeRouteItems((*route_edges)->value(), weight_params_);
+                }
+                continue;
+            }
+            searched.push_back(i);
+            targets.push_back(vertex_to);
+        }
+        if (targets.empty()) {
+            return result;
+        }
+
+        auto routes = router_->BuildRoutes(vertex_from, targets);
+        for (size_t i = 0; i < searched.size(); ++i) {
+            auto route_edges = MakeRouteEdges({vertex_from, targets[i]}, std::move(routes[i]));
+            if (route_edges->has_value()) {
+                result[searched[i]] = MergeRouteItems(route_edges->value(), weight_params_);
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::vector<TravelProps>>
+    TransportRouter::FindParetoRoutes(std::string_view from, std::string_view to, size_t max_bus_count,
+                                      const domain::RouteSettings &settings) const {
+        domain::StopPtr stop_from = tc_.FindStop(from);
+        domain::StopPtr stop_to = tc_.FindStop(to);
+
+        std::vector<std::vector<TravelProps>> result;
+        if (stop_from == nullptr || stop_to == nullptr) {
+            return result;
         }
 
+        const WeightParams weight_params = MakeWeightParams(settings);
+        for (const auto &journey: raptor_router_->FindJourneys(stop_from, stop_to, max_bus_count,
+                                                               weight_params.bus_velocity, weight_params.bus_wait_time)) {
+            std::vector<TravelProps> route;
+            route.reserve(journey.legs.size());
+            for (const auto &leg: journey.legs) {
+                TravelProps travel_unit{leg.from, leg.to, leg.bus, {}, TravelKind::BUS, leg.distance, leg.span_count};
+                travel_unit.travel_duration = EvaluateTravelDuration(travel_unit, weight_params);
+                route.push_back(travel_unit);
+            }
+            result.push_back(std::move(route));
+        }
+        return result;
+    }
+
+    std::vector<std::pair<domain::StopPtr, double>>
+    TransportRouter::FindReachableStops(std::string_view from, double max_time) const {
+        std::vector<std::pair<domain::StopPtr, double>> result;
+        domain::StopPtr stop_from = tc_.FindStop(from);
+        if (stop_from == nullptr) {
+            return result;
+        }
+
+        for (const auto &[vertex_id, duration]: reweighted_router_->BuildReachable(stop_from->id,
+                                                                                   RouteWeight(0, 0.0, max_time))) {
+            //Bus vertices of the expanded graph model aren't stops
+            if (vertex_id < tc_.GetStopCount()) {
+                result.emplace_back(tc_.GetStop(vertex_id), GetTotalTime(duration));
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::optional<double>> TransportRouter::FindTimeMatrix(const std::vector<std::string_view> &from,
+                                                                       const std::vector<std::string_view> &to) const {
+        std::vector<std::optional<double>> result(from.size() * to.size());
+
+        //Indexes of the known destinations and their vertices
+        std::vector<size_t> columns;
+        std::vector<graph::VertexId> targets;
+        for (size_t column = 0; column < to.size(); ++column) {
+            if (domain::StopPtr stop_to = tc_.FindStop(to[column])) {
+                columns.push_back(column);
+                targets.push_back(stop_to->id);
+            }
+        }
+
+        std::atomic<size_t> next_row{0};
+        const size_t thread_count = std::max<size_t>(1, std::min(parallel::GetThreadCount(), from.size()));
+        parallel::RunOnThreads(thread_count, [&](size_t) {
+            for (size_t row = next_row++; row < from.size(); row = next_row++) {
+                domain::StopPtr stop_from = tc_.FindStop(from[row]);
+                if (stop_from == nullptr) {
+                    continue;
+                }
+                const auto weights = reweighted_router_->BuildRouteWeights(stop_from->id, targets);
+                for (size_t i = 0; i < columns.size(); ++i) {
+                    if (weights[i]) {
+                        result[row * to.size() + columns[i]] = GetTotalTime(*weights[i]);
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    std::optional<TravelDuration> TransportRouter::FindRouteDuration(std::string_view from, std::string_view to) const {
+        domain::StopPtr stop_from = tc_.FindStop(from);
+        domain::StopPtr stop_to = tc_.FindStop(to);
+
+        if (stop_from == nullptr || stop_to == nullptr) {
+            return std::nullopt;
+        }
+        if (stop_from == stop_to) {
+            return TravelDuration{};
+        }
+        if (!reachability_.IsReachable(stop_from->id, stop_to->id)) {
+            return std::nullopt;
+        }
+        const auto weight = router_->GetRouteWeight(stop_from->id, stop_to->id);
+        if (!weight) {
+            return std::nullopt;
+        }
+        return ToTravelDuration(*weight);
+    }
+
+    std::shared_ptr<const TransportRouter::RouteEdges>
+    TransportRouter::MakeRouteEdges(const VertexPair &vertex_pair,
+                                    std::optional<graph::RouterBase<RouteWeight>::RouteInfo> route) const {
+        auto route_edges = std::make_shared<const RouteEdges>(
+                route.has_value() ? RouteEdges(std::move(route->edges)) : std::nullopt);
+        route_cache_.Put(vertex_pair, route_edges);
+        return route_edges;
+    }
+
+    std::vector<TravelProps> TransportRouter::MergeRouteItems(const std::vector<graph::EdgeId> &edges,
+                                                              const WeightParams &weight_params) const {
+        std::vector<TravelProps> result;
+        //Boarding, rides and alighting of the expanded graph model collapse into one span item
+        TravelProps span;
+        for (const auto &edge: edges) {
+            const TravelProps &travel_unit = graph_edges_.at(edge);
+            switch (travel_unit.kind) {
+                case TravelKind::BUS:
+                    result.push_back(travel_unit);
+                    result.back().travel_duration = EvaluateTravelDuration(travel_unit, weight_params);
+                    break;
+                case TravelKind::BOARDING:
+                    span = travel_unit;
+                    span.kind = TravelKind::BUS;
+                    break;
+                case TravelKind::RIDE:
+                    span.span_count += travel_unit.span_count;
+                    span.distance += travel_unit.distance;
+                    break;
+                case TravelKind::ALIGHTING:
+                    span.to = travel_unit.to;
+                    span.travel_duration = EvaluateTravelDuration(span, weight_params);
+                    result.push_back(span);
+                    break;
+            }
+        }
         return result;
     }
 
@@ -131,34 +640,102 @@ namespace transport_router {
         return settings_;
     }
 
-    const std::unordered_map<domain::StopPtr, graph::VertexId> TransportRouter::GetGraphVertex() const {
-        return graph_vertexes_;
+    const std::vector<TravelProps>& TransportRouter::GetGraphEdges() const {
+        return graph_edges_;
     }
 
-    const std::vector<TravelProps> TransportRouter::GetGraphEdges() const {
-        return graph_edges_;
+    cache::CacheStats TransportRouter::GetRouteCacheStats() const {
+        return route_cache_.GetStats();
     }
 
-    const std::shared_ptr<graph::Router<TravelDuration>> TransportRouter::GetRouter() const {
+    const std::shared_ptr<graph::RouterBase<RouteWeight>> TransportRouter::GetRouter() const {
         return router_;
     }
 
-    const graph::DirectedWeightedGraph<TravelDuration> TransportRouter::GetGraph() const {
+    const graph::DirectedWeightedGraph<RouteWeight>& TransportRouter::GetGraph() const {
         return graph_;
     }
 
-    void TransportRouter::SetGraphVertex(std::unordered_map<domain::StopPtr, graph::VertexId> &graph_vertex) {
-        graph_vertexes_ = std::move(graph_vertex);
-    }
-
     void TransportRouter::SetGraphEdges(std::vector<TravelProps> &graph_edges) {
         graph_edges_ = std::move(graph_edges);
     }
 
-    void TransportRouter::SetGraph(graph::DirectedWeightedGraph<TravelDuration> &graph) {
+    const TransportRouter::RoutesInternalData* TransportRouter::GetRoutesInternalData() const {
+        const auto *all_pairs_router = dynamic_cast<const graph::Router<RouteWeight>*>(router_.get());
+        if (all_pairs_router == nullptr) {
+            return nullptr;
+        }
+        return &all_pairs_router->GetRoutesInternalData();
+    }
+
+    const TransportRouter::CompactRoutesInternalData* TransportRouter::GetCompactRoutesInternalData() const {
+        const auto *compact_router = dynamic_cast<const graph::CompactRouter<RouteWeight>*>(router_.get());
+        if (compact_router == nullptr) {
+            return nullptr;
+        }
+        return &compact_router->GetRoutesInternalData();
+    }
+
+    const TransportRouter::HierarchyData* TransportRouter::GetHierarchyData() const {
+        const auto *hierarchy = dynamic_cast<const graph::ContractionHierarchy<RouteWeight>*>(router_.get());
+        if (hierarchy == nullptr) {
+            return nullptr;
+        }
+        return &hierarchy->GetHierarchyData();
+    }
+
+    const TransportRouter::HubLabelData* TransportRouter::GetHubLabelData() const {
+        const auto *hub_labels = dynamic_cast<const graph::HubLabels<RouteWeight>*>(router_.get());
+        if (hub_labels == nullptr) {
+            return nullptr;
+        }
+        return &hub_labels->GetLabelData();
+    }
+
+    const TransportRouter::ReachabilityData& TransportRouter::GetReachabilityData() const {
+        return reachability_.GetIndexData();
+    }
+
+    const TransportRouter::OverlayPartition* TransportRouter::GetOverlayPartition() const {
+        const auto *overlay = dynamic_cast<const graph::MultiLevelOverlay<RouteWeight>*>(router_.get());
+        if (overlay == nullptr) {
+            return nullptr;
+        }
+        return &overlay->GetPartition();
+    }
+
+    void TransportRouter::SetGraph(graph::DirectedWeightedGraph<RouteWeight> &graph) {
         graph_ = std::move(graph);
-        router_ = std::make_unique<graph::Router<TravelDuration>>(graph_);
     }
 
+    void TransportRouter::SetRoutesInternalData(RoutesInternalData &routes_internal_data) {
+        ResetRouterHelpers();
+        router_ = std::make_shared<graph::Router<RouteWeight>>(graph_, std::move(routes_internal_data));
+    }
+
+    void TransportRouter::SetCompactRoutesInternalData(CompactRoutesInternalData &routes_internal_data) {
+        ResetRouterHelpers();
+        router_ = std::make_shared<graph::CompactRouter<RouteWeight>>(graph_, std::move(routes_internal_data));
+    }
+
+    void TransportRouter::SetHierarchyData(HierarchyData &hierarchy_data) {
+        ResetRouterHelpers();
+        router_ = std::make_shared<graph::ContractionHierarchy<RouteWeight>>(graph_, std::move(hierarchy_data));
+    }
+
+    void TransportRouter::SetOverlayPartition(OverlayPartition &overlay_partition) {
+        ResetRouterHelpers();
+        overlay_partition_ = std::move(overlay_partition);
+        router_ = std::make_shared<graph::MultiLevelOverlay<RouteWeight>>(graph_, overlay_partition_);
+    }
+
+    void TransportRouter::SetHubLabelData(HubLabelData &hub_label_data) {
+        ResetRouterHelpers();
+        router_ = std::make_shared<graph::HubLabels<RouteWeight>>(graph_, std::move(hub_label_data));
+    }
+
+    void TransportRouter::SetReachabilityData(ReachabilityData &reachability_data) {
+        reachability_ = graph::ReachabilityIndex(graph_, std::move(reachability_data));
+    }
 
 }
@@ -3,7 +3,24 @@
 #include "transport_catalogue.h"
 #include "graph.h"
 #include "router.h"
+#include "astar_router.h"
+#include "dijkstra_router.h"
+#include "compact_router.h"
+#include "contraction_hierarchy.h"
+#include "multi_level_overlay.h"
+#include "hub_labels.h"
+#include "reachability_index.h"
+#include "raptor_router.h"
+#include "lru_cache.h"
+#include "parallel.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <numeric>
 
 
 namespace transport_router {
@@ -20,11 +37,29 @@ namespace transport_router {
         double travel_time = 0.0;
     };
 
+    enum class TravelKind {
+        BUS,            //ride from one stop to another including the wait (complete graph model)
+        BOARDING,       //wait at the stop and board the bus (expanded graph model)
+        RIDE,           //ride between consecutive stops of the bus (expanded graph model)
+        ALIGHTING,      //leave the bus at the stop (expanded graph model)
+    };
+
     struct TravelProps {
         domain::StopPtr from = nullptr;
         domain::StopPtr to = nullptr;
         domain::BusPtr route = nullptr;
         TravelDuration travel_duration = {};
+        TravelKind kind = TravelKind::BUS;
+        size_t distance = 0;        //road distance in meters
+        int span_count = 0;         //stops passed on the bus
+    };
+
+    //RouteSettings in the units of the edge weights
+    struct WeightParams {
+        double bus_velocity = 0.0;      //m/s
+        double bus_wait_time = 0.0;     //seconds
+
+        bool operator==(const WeightParams &other) const;
     };
 
     TravelDuration operator+(const TravelDuration& lhs, const TravelDuration& rhs);
@@ -33,6 +68,87 @@ namespace transport_router {
 
     bool operator>(const TravelDuration& lhs, const TravelDuration& rhs);
 
+    //Graph weight with the total time in integer milliseconds: relaxations compare and add integers
+    //instead of summing the waiting and travel time of both sides
+    struct FixedTravelDuration {
+        FixedTravelDuration() = default;
+
+        FixedTravelDuration(int stops_number, double waiting_time, double travel_time)
+                : stops_number(stops_number), total_time(std::llround((waiting_time + travel_time) * 1000)) {
+        }
+
+        int stops_number = 0;
+        int64_t total_time = 0;     //milliseconds
+    };
+
+    inline FixedTravelDuration operator+(const FixedTravelDuration& lhs, const FixedTravelDuration& rhs) {
+        FixedTravelDuration result;
+        result.stops_number = lhs.stops_number + rhs.stops_number;
+        result.total_time = lhs.total_time + rhs.total_time;
+        return result;
+    }
+
+    inline bool operator<(const FixedTravelDuration& lhs, const FixedTravelDuration& rhs) {
+        return lhs.total_time < rhs.total_time;
+    }
+
+    inline bool operator>(const FixedTravelDuration& lhs, const FixedTravelDuration& rhs) {
+        return lhs.total_time > rhs.total_time;
+    }
+
+    //Weight of the routing graph, chosen by the TRANSPORT_FIXED_POINT_WEIGHTS build option
+#ifdef TRANSPORT_FIXED_POINT_WEIGHTS
+    using RouteWeight = FixedTravelDuration;
+#else
+    using RouteWeight = TravelDuration;
+#endif
+
+    inline RouteWeight ToRouteWeight(const TravelDuration& duration) {
+        return RouteWeight(duration.stops_number, duration.waiting_time, duration.travel_time);
+    }
+
+    //The fixed point weight keeps the total only, it comes back as the travel time
+    inline TravelDuration ToTravelDuration(const TravelDuration& weight) {
+        return weight;
+    }
+
+    inline TravelDuration ToTravelDuration(const FixedTravelDuration& weight) {
+        return {weight.stops_number, 0.0, weight.total_time / 1000.0};
+    }
+
+    //Total time in seconds
+    inline double GetTotalTime(const TravelDuration& weight) {
+        return weight.waiting_time + weight.travel_time;
+    }
+
+    inline double GetTotalTime(const FixedTravelDuration& weight) {
+        return weight.total_time / 1000.0;
+    }
+
+}
+
+namespace graph {
+
+    template <>
+    struct WeightTraits<transport_router::TravelDuration> {
+        //Total time in milliseconds
+        static uint64_t ToFixedPoint(const transport_router::TravelDuration& weight) {
+            return static_cast<uint64_t>(std::llround((weight.waiting_time + weight.travel_time) * 1000));
+        }
+    };
+
+    template <>
+    struct WeightTraits<transport_router::FixedTravelDuration> {
+        //Already in milliseconds
+        static uint64_t ToFixedPoint(const transport_router::FixedTravelDuration& weight) {
+            return static_cast<uint64_t>(weight.total_time);
+        }
+    };
+
+}
+
+namespace transport_router {
+
     class DistanceCalc {
     public:
 
@@ -46,43 +162,135 @@ namespace transport_router {
 
     };
 
+    namespace detail {
+        struct VertexPairHasher {
+            size_t operator()(const std::pair<graph::VertexId, graph::VertexId> vertex_pair) const;
+
+        private:
+            std::hash<graph::VertexId> hasher;
+        };
+    }
+
     class TransportRouter {
     public:
 
+        using RoutesInternalData = graph::Router<RouteWeight>::RoutesInternalData;
+        using CompactRoutesInternalData = graph::CompactRouter<RouteWeight>::RoutesInternalData;
+        using HierarchyData = graph::ContractionHierarchy<RouteWeight>::HierarchyData;
+        using OverlayPartition = graph::MultiLevelOverlay<RouteWeight>::Partition;
+        using HubLabelData = graph::HubLabels<RouteWeight>::LabelData;
+        using ReachabilityData = graph::ReachabilityIndex::IndexData;
+
         explicit TransportRouter(const transport_catalogue::TransportCatalogue &catalogue);
 
         void RouteInit(const domain::RouteSettings &settings);
 
-        std::optional<std::vector<const transport_router::TravelProps*>> FindRoute(std::string_view from, std::string_view to) const;
+        std::optional<std::vector<transport_router::TravelProps>> FindRoute(std::string_view from, std::string_view to) const;
+        //Route for other velocity and wait time than the active settings, found by a search over re-evaluated weights
+        std::optional<std::vector<transport_router::TravelProps>> FindRoute(std::string_view from, std::string_view to,
+                                                                           const domain::RouteSettings &settings) const;
+        //Routes from one stop to many, answered from a single search where the engine allows it
+        std::vector<std::optional<std::vector<transport_router::TravelProps>>>
+        FindRoutes(std::string_view from, const std::vector<std::string_view> &to) const;
+        //Routes faster than every route with fewer buses, ordered by the number of buses and found by RAPTOR
+        //on the stop sequences of the buses. max_bus_count limits the buses, 0 means no limit.
+        std::vector<std::vector<transport_router::TravelProps>> FindParetoRoutes(std::string_view from, std::string_view to,
+                                                                                 size_t max_bus_count,
+                                                                                 const domain::RouteSettings &settings) const;
+        //Stops reachable from the stop within max_time seconds and the arrival times in seconds, earliest first.
+        //Answered by a search bounded by max_time, so it doesn't need the all-pairs table.
+        std::vector<std::pair<domain::StopPtr, double>> FindReachableStops(std::string_view from, double max_time) const;
+        //Route times in seconds from every origin to every destination in row-major order, nullopt if there is
+        //no route or no such stop. One search per origin, the origins are split between threads.
+        std::vector<std::optional<double>> FindTimeMatrix(const std::vector<std::string_view> &from,
+                                                          const std::vector<std::string_view> &to) const;
+        //Duration of the route without its items
+        std::optional<TravelDuration> FindRouteDuration(std::string_view from, std::string_view to) const;
 
         const domain::RouteSettings GetRouteSettings() const;
 
-        const std::unordered_map<domain::StopPtr, graph::VertexId> GetGraphVertex() const;
-        const std::vector<TravelProps> GetGraphEdges() const;
+        const std::vector<TravelProps>& GetGraphEdges() const;
 
-        const std::shared_ptr<graph::Router<TravelDuration>> GetRouter() const;
-        const graph::DirectedWeightedGraph<TravelDuration> GetGraph() const;
+        const std::shared_ptr<graph::RouterBase<RouteWeight>> GetRouter() const;
+        const graph::DirectedWeightedGraph<RouteWeight>& GetGraph() const;
+        const RoutesInternalData* GetRoutesInternalData() const;
+        const CompactRoutesInternalData* GetCompactRoutesInternalData() const;
+        const HierarchyData* GetHierarchyData() const;
+        const OverlayPartition* GetOverlayPartition() const;
+        const HubLabelData* GetHubLabelData() const;
+        const ReachabilityData& GetReachabilityData() const;
+        cache::CacheStats GetRouteCacheStats() const;
 
         void SetRouteSettings(const domain::RouteSettings &settings);
+        //Re-evaluates the edge weights of the built graph and rebuilds the router. Settings that keep the weights
+        //and the engine only update the route cache, the loaded router stays.
+        void UpdateRouteSettings(const domain::RouteSettings &settings);
 
-        void SetGraphVertex(std::unordered_map<domain::StopPtr, graph::VertexId>& graph_vertex);
         void SetGraphEdges(std::vector<TravelProps> &graph_edges);
 
-        void SetGraph(graph::DirectedWeightedGraph<TravelDuration> &graph);
+        void SetGraph(graph::DirectedWeightedGraph<RouteWeight> &graph);
+        void SetRoutesInternalData(RoutesInternalData &routes_internal_data);
+        void SetCompactRoutesInternalData(CompactRoutesInternalData &routes_internal_data);
+        void SetHierarchyData(HierarchyData &hierarchy_data);
+        //Keeps the partition and customizes the overlay for the current weights
+        void SetOverlayPartition(OverlayPartition &overlay_partition);
+        void SetHubLabelData(HubLabelData &hub_label_data);
+        void SetReachabilityData(ReachabilityData &reachability_data);
+
+        void BuildRouter();
 
     private:
 
         domain::RouteSettings settings_;
+        WeightParams weight_params_;
 
         const transport_catalogue::TransportCatalogue &tc_;
-        graph::DirectedWeightedGraph<TravelDuration> graph_;
-        std::unordered_map<domain::StopPtr, graph::VertexId> graph_vertexes_;
+        graph::DirectedWeightedGraph<RouteWeight> graph_;
         std::vector<TravelProps> graph_edges_;
 
-        std::shared_ptr<graph::Router<TravelDuration>> router_;
+        std::shared_ptr<graph::RouterBase<RouteWeight>> router_;
+        //Searches with weights of other settings
+        std::unique_ptr<graph::DijkstraRouter<RouteWeight>> reweighted_router_;
+        std::unique_ptr<RaptorRouter> raptor_router_;
+
+        //A* lower bound: chord distance to the target times the smallest ride time per meter of an edge,
+        //plus the smallest wait when leaving a stop vertex (stop vertices have the lowest ids)
+        std::vector<geo::CartesianPoint> vertex_points_;
+        double seconds_per_meter_ = 0.0;
+        double stop_wait_time_ = 0.0;
+
+        //Cells of the multi-level overlay engine, they follow the topology and survive the weight updates
+        OverlayPartition overlay_partition_;
+
+        //Unreachable pairs are answered without a search, the index follows the topology
+        graph::ReachabilityIndex reachability_;
+
+        //Edges of the found route, nullopt if the route doesn't exist
+        using RouteEdges = std::optional<std::vector<graph::EdgeId>>;
+        using VertexPair = std::pair<graph::VertexId, graph::VertexId>;
+        mutable cache::LruCache<VertexPair, std::shared_ptr<const RouteEdges>, detail::VertexPairHasher> route_cache_;
+
+        static WeightParams MakeWeightParams(const domain::RouteSettings &settings);
+        static TravelDuration EvaluateTravelDuration(const TravelProps &travel_unit, const WeightParams &weight_params);
+
+        //Route cache, reweighted_router_ and raptor_router_ follow the current graph and router
+        void ResetRouterHelpers();
 
-        void FillGraphStop();
+        void AddGraphEdge(graph::VertexId from, graph::VertexId to, TravelProps travel_unit);
         void FillGraphBuses();
+        void FillExpandedGraphBuses();
+        std::vector<domain::BusPtr> GetBusesInGraphOrder() const;
+        void FreezeGraph();
+        void FillVertexPoints();
+        void PrepareLowerBound();
+        OverlayPartition MakeOverlayPartition();
+        RouteWeight GetLowerBound(graph::VertexId from, graph::VertexId to) const;
+        void AddBusChain(domain::BusPtr bus, DistanceCalc &distance_calc, bool is_forward, graph::VertexId first_vertex);
+
+        std::shared_ptr<const RouteEdges> MakeRouteEdges(const VertexPair &vertex_pair,
+                                                         std::optional<graph::RouterBase<RouteWeight>::RouteInfo> route) const;
+        std::vector<TravelProps> MergeRouteItems(const std::vector<graph::EdgeId> &edges,
+                                                 const WeightParams &weight_params) const;
     };
 
 }